@@ -611,6 +611,9 @@ int Application::exec(const QStringList &params)
         BitTorrent::Session::initInstance();
         connect(BitTorrent::Session::instance(), &BitTorrent::Session::torrentFinished, this, &Application::torrentFinished);
         connect(BitTorrent::Session::instance(), &BitTorrent::Session::allTorrentsFinished, this, &Application::allTorrentsFinished, Qt::QueuedConnection);
+#if (!defined(DISABLE_GUI) && defined(Q_OS_WIN))
+        connect(BitTorrent::Session::instance(), &BitTorrent::Session::resumeDataSaveProgress, this, &Application::resumeDataSaveProgress);
+#endif
 
         Net::GeoIPManager::initInstance();
         TorrentFilesWatcher::initInstance();
@@ -762,6 +765,7 @@ void Application::shutdownCleanup(QSessionManager &manager)
     // and the user clicks "Cancel", it will result in qbt being
     // killed and the shutdown proceeding instead. Apparently
     // aboutToQuit() is emitted too late in the shutdown process.
+    m_isSystemShuttingDown = true;
     cleanup();
 
     // According to the qt docs we shouldn't call quit() inside a slot.
@@ -769,6 +773,17 @@ void Application::shutdownCleanup(QSessionManager &manager)
     // the above dialog.
     QTimer::singleShot(0, qApp, &QCoreApplication::quit);
 }
+
+void Application::resumeDataSaveProgress(const int savedCount, const int totalCount)
+{
+    // Progress is written to the log by the session, here it is only
+    // shown to the user while the OS shutdown is blocked by us
+    if (!m_isSystemShuttingDown || !m_window)
+        return;
+
+    const QString progressMsg = tr("Saving torrent progress... %1/%2").arg(QString::number(savedCount), QString::number(totalCount));
+    ::ShutdownBlockReasonCreate(reinterpret_cast<HWND>(m_window->effectiveWinId()), progressMsg.toStdWString().c_str());
+}
 #endif
 
 void Application::cleanup()
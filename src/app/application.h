@@ -118,6 +118,7 @@ private slots:
     void cleanup();
 #if (!defined(DISABLE_GUI) && defined(Q_OS_WIN))
     void shutdownCleanup(QSessionManager &manager);
+    void resumeDataSaveProgress(int savedCount, int totalCount);
 #endif
 
 private:
@@ -135,6 +136,10 @@ private:
     QPointer<MainWindow> m_window;
 #endif
 
+#if (!defined(DISABLE_GUI) && defined(Q_OS_WIN))
+    bool m_isSystemShuttingDown = false;
+#endif
+
 #ifndef DISABLE_WEBUI
     WebUI *m_webui = nullptr;
 #endif
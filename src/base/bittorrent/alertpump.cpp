@@ -0,0 +1,186 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2021  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "alertpump.h"
+
+#include <utility>
+
+#include <libtorrent/alert_types.hpp>
+#include <libtorrent/session.hpp>
+#include <libtorrent/time.hpp>
+
+#include <QDebug>
+#include <QMutexLocker>
+
+namespace
+{
+    // How often the pump thread checks whether it is requested to stop
+    const int WAIT_INTERVAL = 100; // ms
+}
+
+BitTorrent::AlertPump::AlertPump(lt::session *nativeSession, InlineHandler inlineHandler
+        , AlertsHandler alertsHandler, StatusesHandler statusesHandler, QObject *parent)
+    : QObject {parent}
+    , m_nativeSession {nativeSession}
+    , m_inlineHandler {std::move(inlineHandler)}
+    , m_alertsHandler {std::move(alertsHandler)}
+    , m_statusesHandler {std::move(statusesHandler)}
+{
+    m_threadPool.setMaxThreadCount(1);
+    m_threadPool.setExpiryTimeout(-1);
+}
+
+BitTorrent::AlertPump::~AlertPump()
+{
+    stop();
+}
+
+void BitTorrent::AlertPump::start()
+{
+    m_isStopRequested.storeRelease(0);
+    m_alertsProcessed.tryAcquire(m_alertsProcessed.available());
+    m_threadPool.start([this]() { run(); });
+}
+
+void BitTorrent::AlertPump::stop()
+{
+    m_isStopRequested.storeRelease(1);
+    m_threadPool.waitForDone();
+
+    // Pump thread is finished so it's safe to handle the alerts it left
+    processAlerts();
+    processStatuses();
+}
+
+void BitTorrent::AlertPump::run()
+{
+    while (!m_isStopRequested.loadAcquire())
+    {
+        m_nativeSession->wait_for_alert(lt::milliseconds {WAIT_INTERVAL});
+
+        std::vector<lt::alert *> alerts;
+        m_nativeSession->pop_alerts(&alerts);
+
+        std::vector<lt::alert *> orderedAlerts;
+        std::vector<const lt::state_update_alert *> stateUpdateAlerts;
+        for (lt::alert *a : alerts)
+        {
+            if (a->type() == lt::state_update_alert::alert_type)
+            {
+                stateUpdateAlerts.push_back(static_cast<const lt::state_update_alert *>(a));
+                continue;
+            }
+
+            try
+            {
+                if (m_inlineHandler(a))
+                    continue;
+            }
+            catch (const std::exception &exc)
+            {
+                qWarning() << "Caught exception in " << Q_FUNC_INFO << ": " << QString::fromStdString(exc.what());
+                continue;
+            }
+
+            orderedAlerts.push_back(a);
+        }
+
+        if (!orderedAlerts.empty())
+        {
+            m_alerts = std::move(orderedAlerts);
+            m_hasUnprocessedAlerts = true;
+            QMetaObject::invokeMethod(this, &AlertPump::processAlerts, Qt::QueuedConnection);
+
+            while (!m_alertsProcessed.tryAcquire(1, WAIT_INTERVAL))
+            {
+                // The rest will be handled by stop()
+                if (m_isStopRequested.loadAcquire())
+                    return;
+            }
+        }
+
+        // Statuses are merged only after the preceding alerts are processed
+        // so that they don't reach the torrents that aren't added yet
+        if (!stateUpdateAlerts.empty())
+        {
+            const QMutexLocker locker {&m_statusesMutex};
+
+            for (const lt::state_update_alert *stateUpdateAlert : stateUpdateAlerts)
+            {
+                for (const lt::torrent_status &status : stateUpdateAlert->status)
+                {
+#ifdef QBT_USES_LIBTORRENT2
+                    const auto id = TorrentID::fromInfoHash(status.info_hashes);
+#else
+                    const auto id = TorrentID::fromInfoHash(status.info_hash);
+#endif
+                    m_pendingStatuses.insert(id, status);
+                }
+            }
+
+            // State update alert needs to be delivered even if it has no statuses
+            if (!m_isStatusesDeliveryScheduled)
+            {
+                m_isStatusesDeliveryScheduled = true;
+                QMetaObject::invokeMethod(this, &AlertPump::processStatuses, Qt::QueuedConnection);
+            }
+        }
+    }
+}
+
+void BitTorrent::AlertPump::processAlerts()
+{
+    if (!m_hasUnprocessedAlerts)
+        return;
+
+    m_alertsHandler(m_alerts);
+
+    m_alerts.clear();
+    m_hasUnprocessedAlerts = false;
+    m_alertsProcessed.release();
+}
+
+void BitTorrent::AlertPump::processStatuses()
+{
+    std::vector<lt::torrent_status> statuses;
+
+    {
+        const QMutexLocker locker {&m_statusesMutex};
+
+        if (!m_isStatusesDeliveryScheduled)
+            return;
+
+        statuses.reserve(static_cast<std::size_t>(m_pendingStatuses.size()));
+        for (auto it = m_pendingStatuses.begin(); it != m_pendingStatuses.end(); ++it)
+            statuses.push_back(std::move(it.value()));
+        m_pendingStatuses.clear();
+        m_isStatusesDeliveryScheduled = false;
+    }
+
+    m_statusesHandler(statuses);
+}
@@ -0,0 +1,95 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2021  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include <libtorrent/fwd.hpp>
+#include <libtorrent/torrent_status.hpp>
+
+#include <QAtomicInt>
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QSemaphore>
+#include <QThreadPool>
+
+#include "infohash.h"
+
+namespace BitTorrent
+{
+    // Pops libtorrent alerts in a dedicated thread and sorts them by type:
+    // - alerts that can be handled right away (thread-safe ones) are passed to the inline handler in pump thread,
+    // - torrent status updates are coalesced (only the latest status of each torrent is kept)
+    //   and delivered to the owner thread in bulk,
+    // - all the other alerts are delivered to the owner thread in their original order.
+    class AlertPump final : public QObject
+    {
+        Q_OBJECT
+        Q_DISABLE_COPY_MOVE(AlertPump)
+
+    public:
+        // Called in pump thread. Returns `false` if the alert should be handled in owner thread.
+        using InlineHandler = std::function<bool (const lt::alert *alert)>;
+        using AlertsHandler = std::function<void (const std::vector<lt::alert *> &alerts)>;
+        using StatusesHandler = std::function<void (const std::vector<lt::torrent_status> &statuses)>;
+
+        AlertPump(lt::session *nativeSession, InlineHandler inlineHandler
+                  , AlertsHandler alertsHandler, StatusesHandler statusesHandler, QObject *parent = nullptr);
+        ~AlertPump() override;
+
+        void start();
+        // Already popped alerts are handled before returning
+        void stop();
+
+    private:
+        void run();
+        void processAlerts();
+        void processStatuses();
+
+        lt::session *m_nativeSession = nullptr;
+        const InlineHandler m_inlineHandler;
+        const AlertsHandler m_alertsHandler;
+        const StatusesHandler m_statusesHandler;
+
+        QThreadPool m_threadPool;
+        QAtomicInt m_isStopRequested;
+
+        // Alerts are valid only until the next pop so the pump thread
+        // waits for them to be processed before it continues
+        std::vector<lt::alert *> m_alerts;
+        bool m_hasUnprocessedAlerts = false;
+        QSemaphore m_alertsProcessed;
+
+        QMutex m_statusesMutex;
+        QHash<TorrentID, lt::torrent_status> m_pendingStatuses;
+        bool m_isStatusesDeliveryScheduled = false;
+    };
+}
@@ -50,6 +50,7 @@
 #include "base/utils/string.h"
 #include "infohash.h"
 #include "loadtorrentparams.h"
+#include "resumedataloader.h"
 
 namespace BitTorrent
 {
@@ -71,6 +72,8 @@ namespace BitTorrent
 
 namespace
 {
+    const int LOADALL_PREFETCH_LIMIT = 256;
+
     template <typename LTStr>
     QString fromLTString(const LTStr &str)
     {
@@ -158,6 +161,17 @@ std::optional<BitTorrent::LoadTorrentParams> BitTorrent::BencodeResumeDataStorag
     return loadTorrentResumeData(data, metadata);
 }
 
+void BitTorrent::BencodeResumeDataStorage::loadAll(const LoadAllCallback &callback) const
+{
+    // Resume data files are read and parsed by several threads in parallel
+    ResumeDataLoader loader {this, m_registeredTorrents, LOADALL_PREFETCH_LIMIT};
+    while (const std::optional<ResumeDataLoader::Result> loadResult = loader.takeNext())
+    {
+        if (!callback(loadResult->torrentID, loadResult->resumeData))
+            break;
+    }
+}
+
 std::optional<BitTorrent::LoadTorrentParams> BitTorrent::BencodeResumeDataStorage::loadTorrentResumeData(
         const QByteArray &data, const QByteArray &metadata) const
 {
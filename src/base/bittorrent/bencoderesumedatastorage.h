@@ -49,6 +49,7 @@ namespace BitTorrent
 
         QVector<TorrentID> registeredTorrents() const override;
         std::optional<LoadTorrentParams> load(const TorrentID &id) const override;
+        void loadAll(const LoadAllCallback &callback) const override;
         void store(const TorrentID &id, const LoadTorrentParams &resumeData) const override;
         void remove(const TorrentID &id) const override;
         void storeQueue(const QVector<TorrentID> &queue) const override;
@@ -28,6 +28,10 @@
 
 #include "dbresumedatastorage.h"
 
+#include <algorithm>
+#include <optional>
+#include <utility>
+
 #include <libtorrent/bdecode.hpp>
 #include <libtorrent/bencode.hpp>
 #include <libtorrent/entry.hpp>
@@ -35,13 +39,16 @@
 #include <libtorrent/torrent_info.hpp>
 #include <libtorrent/write_resume_data.hpp>
 
+#include <QAtomicInt>
 #include <QByteArray>
 #include <QFile>
+#include <QHash>
 #include <QSet>
 #include <QSqlDatabase>
 #include <QSqlError>
 #include <QSqlQuery>
 #include <QThread>
+#include <QTimer>
 #include <QVector>
 
 #include "base/exceptions.h"
@@ -57,10 +64,11 @@ namespace
 {
     const char DB_CONNECTION_NAME[] = "ResumeDataStorage";
 
-    const int DB_VERSION = 1;
+    const int DB_VERSION = 2;
 
     const char DB_TABLE_META[] = "meta";
     const char DB_TABLE_TORRENTS[] = "torrents";
+    const char DB_TABLE_TORRENTS_METADATA[] = "torrents_metadata";
 
     struct Column
     {
@@ -89,6 +97,7 @@ namespace
     const Column DB_COLUMN_STOPPED = makeColumn("stopped");
     const Column DB_COLUMN_RESUMEDATA = makeColumn("libtorrent_resume_data");
     const Column DB_COLUMN_METADATA = makeColumn("metadata");
+    const Column DB_COLUMN_DATA = makeColumn("data");
     const Column DB_COLUMN_VALUE = makeColumn("value");
 
     template <typename LTStr>
@@ -151,10 +160,88 @@ namespace
     {
         return QString::fromLatin1("%1 %2").arg(quoted(column.name), QLatin1String(definition));
     }
+
+    QString makeCreateTableTorrentsMetadataStatement()
+    {
+        const QStringList tableTorrentsMetadataItems = {
+            makeColumnDefinition(DB_COLUMN_TORRENT_ID, "BLOB NOT NULL PRIMARY KEY"),
+            makeColumnDefinition(DB_COLUMN_DATA, "BLOB NOT NULL")
+        };
+        return makeCreateTableStatement(DB_TABLE_TORRENTS_METADATA, tableTorrentsMetadataItems);
+    }
+
+    // Torrent metadata is immutable so it is stored separately (once per torrent)
+    // and joined to the frequently updated resume data when loading.
+    QString makeSelectTorrentsStatement()
+    {
+        return QString::fromLatin1("SELECT %1.*, %2.%3 FROM %1 LEFT JOIN %2 ON %1.%4 = %2.%4")
+                .arg(quoted(DB_TABLE_TORRENTS), quoted(DB_TABLE_TORRENTS_METADATA)
+                     , quoted(DB_COLUMN_DATA.name), quoted(DB_COLUMN_TORRENT_ID.name));
+    }
+
+    BitTorrent::LoadTorrentParams parseQueryResultRow(const QSqlQuery &query)
+    {
+        BitTorrent::LoadTorrentParams resumeData;
+        resumeData.restored = true;
+        resumeData.name = query.value(DB_COLUMN_NAME.name).toString();
+        resumeData.category = query.value(DB_COLUMN_CATEGORY.name).toString();
+        const QString tagsData = query.value(DB_COLUMN_TAGS.name).toString();
+        if (!tagsData.isEmpty())
+        {
+            const QStringList tagList = tagsData.split(QLatin1Char(','));
+            resumeData.tags.insert(tagList.cbegin(), tagList.cend());
+        }
+        resumeData.savePath = Profile::instance()->fromPortablePath(
+                    Utils::Fs::toUniformPath(query.value(DB_COLUMN_TARGET_SAVE_PATH.name).toString()));
+        resumeData.hasSeedStatus = query.value(DB_COLUMN_HAS_SEED_STATUS.name).toBool();
+        resumeData.firstLastPiecePriority = query.value(DB_COLUMN_HAS_OUTER_PIECES_PRIORITY.name).toBool();
+        resumeData.ratioLimit = query.value(DB_COLUMN_RATIO_LIMIT.name).toInt() / 1000.0;
+        resumeData.seedingTimeLimit = query.value(DB_COLUMN_SEEDING_TIME_LIMIT.name).toInt();
+        resumeData.contentLayout = Utils::String::toEnum<BitTorrent::TorrentContentLayout>(
+                    query.value(DB_COLUMN_CONTENT_LAYOUT.name).toString(), BitTorrent::TorrentContentLayout::Original);
+        resumeData.operatingMode = Utils::String::toEnum<BitTorrent::TorrentOperatingMode>(
+                    query.value(DB_COLUMN_OPERATING_MODE.name).toString(), BitTorrent::TorrentOperatingMode::AutoManaged);
+        resumeData.stopped = query.value(DB_COLUMN_STOPPED.name).toBool();
+
+        const QByteArray bencodedResumeData = query.value(DB_COLUMN_RESUMEDATA.name).toByteArray();
+        const QByteArray bencodedMetadata = query.value(DB_COLUMN_DATA.name).toByteArray();
+        const QByteArray allData = ((bencodedMetadata.isEmpty() || bencodedResumeData.isEmpty())
+                                    ? bencodedResumeData
+                                    : (bencodedResumeData.chopped(1) + bencodedMetadata.mid(1)));
+
+        lt::error_code ec;
+        const lt::bdecode_node root = lt::bdecode(allData, ec);
+
+        lt::add_torrent_params &p = resumeData.ltAddTorrentParams;
+
+        p = lt::read_resume_data(root, ec);
+        p.save_path = Profile::instance()->fromPortablePath(fromLTString(p.save_path)).toStdString();
+
+        return resumeData;
+    }
 }
 
 namespace BitTorrent
 {
+    // Database connection used to load resume data from threads other than
+    // the one owning the storage (e.g. startup loading pool). It is owned
+    // by QThreadStorage and gets removed when its thread finishes.
+    class DBResumeDataStorage::LoadingConnection
+    {
+        Q_DISABLE_COPY_MOVE(LoadingConnection)
+
+    public:
+        explicit LoadingConnection(const QString &dbPath);
+        ~LoadingConnection();
+
+        QSqlDatabase database() const;
+
+    private:
+        QString m_connectionName;
+    };
+
+    // Coalesces incoming write requests and applies them
+    // in a single transaction per flush window
     class DBResumeDataStorage::Worker final : public QObject
     {
         Q_DISABLE_COPY_MOVE(Worker)
@@ -162,21 +249,45 @@ namespace BitTorrent
     public:
         Worker(const QString &dbPath, const QString &dbConnectionName);
 
-        void openDatabase() const;
-        void closeDatabase() const;
+        void openDatabase();
+        void closeDatabase();
 
-        void store(const TorrentID &id, const LoadTorrentParams &resumeData) const;
-        void remove(const TorrentID &id) const;
-        void storeQueue(const QVector<TorrentID> &queue) const;
+        void setSynchronousLevel(int level) const;
+        void setWriteBatchSize(int size);
+        void setWriteBatchDelay(int delay);
+
+        void store(const TorrentID &id, const LoadTorrentParams &resumeData);
+        void remove(const TorrentID &id);
+        void storeQueue(const QVector<TorrentID> &queue);
 
     private:
+        int pendingCount() const;
+        void scheduleFlush();
+        void flush();
+        void restorePending(const QHash<TorrentID, LoadTorrentParams> &stores
+                , const QSet<TorrentID> &removals, const std::optional<QVector<TorrentID>> &queue);
+
+        void storeTorrent(QSqlQuery &query, const TorrentID &id, const LoadTorrentParams &resumeData);
+        void removeTorrent(QSqlQuery &query, const TorrentID &id);
+        void storeTorrentsQueue(QSqlQuery &query, const QVector<TorrentID> &queue) const;
+
         const QString m_path;
         const QString m_connectionName;
+        int m_writeBatchSize = 100;
+        QTimer *m_flushTimer = nullptr;
+
+        QHash<TorrentID, LoadTorrentParams> m_pendingStores;
+        QSet<TorrentID> m_pendingRemovals;
+        std::optional<QVector<TorrentID>> m_pendingQueue;
+
+        // Torrents which metadata is already stored in database
+        QSet<TorrentID> m_storedMetadata;
     };
 }
 
 BitTorrent::DBResumeDataStorage::DBResumeDataStorage(const QString &dbPath, QObject *parent)
     : ResumeDataStorage {parent}
+    , m_dbPath {dbPath}
     , m_ioThread {new QThread(this)}
 {
     const bool needCreateDB = !QFile::exists(dbPath);
@@ -187,7 +298,24 @@ BitTorrent::DBResumeDataStorage::DBResumeDataStorage(const QString &dbPath, QObj
         throw RuntimeError(db.lastError().text());
 
     if (needCreateDB)
+    {
         createDB();
+    }
+    else
+    {
+        const int dbVersion = currentDBVersion();
+        if (dbVersion > DB_VERSION)
+            throw RuntimeError(tr("Database was created by a newer version of qBittorrent (database version: %1)").arg(dbVersion));
+        if (dbVersion < DB_VERSION)
+            updateDB(dbVersion);
+    }
+
+    // Write-ahead logging allows to read the database while the worker writes to it
+    // and makes commits cheaper since they need fewer fsyncs
+    QSqlQuery walQuery {db};
+    if (!walQuery.exec(QLatin1String("PRAGMA journal_mode = WAL;")))
+        LogMsg(tr("Couldn't enable write-ahead logging for resume data database. Error: %1")
+            .arg(walQuery.lastError().text()), Log::WARNING);
 
     m_asyncWorker = new Worker(dbPath, QLatin1String("ResumeDataStorageWorker"));
     m_asyncWorker->moveToThread(m_ioThread);
@@ -213,7 +341,8 @@ BitTorrent::DBResumeDataStorage::DBResumeDataStorage(const QString &dbPath, QObj
 
 BitTorrent::DBResumeDataStorage::~DBResumeDataStorage()
 {
-    QMetaObject::invokeMethod(m_asyncWorker, &Worker::closeDatabase);
+    // Pending writes must be flushed before the thread is stopped
+    QMetaObject::invokeMethod(m_asyncWorker, &Worker::closeDatabase, Qt::BlockingQueuedConnection);
     QSqlDatabase::removeDatabase(DB_CONNECTION_NAME);
 
     m_ioThread->quit();
@@ -241,12 +370,11 @@ QVector<BitTorrent::TorrentID> BitTorrent::DBResumeDataStorage::registeredTorren
 
 std::optional<BitTorrent::LoadTorrentParams> BitTorrent::DBResumeDataStorage::load(const TorrentID &id) const
 {
-    const QString selectTorrentStatement =
-            QString(QLatin1String("SELECT * FROM %1 WHERE %2 = %3;"))
+    const QString selectTorrentStatement = makeSelectTorrentsStatement()
+            + QString::fromLatin1(" WHERE %1.%2 = %3;")
             .arg(quoted(DB_TABLE_TORRENTS), quoted(DB_COLUMN_TORRENT_ID.name), DB_COLUMN_TORRENT_ID.placeholder);
 
-    auto db = QSqlDatabase::database(DB_CONNECTION_NAME);
-    QSqlQuery query {db};
+    QSqlQuery query {loadingConnection()};
     try
     {
         if (!query.prepare(selectTorrentStatement))
@@ -266,43 +394,30 @@ std::optional<BitTorrent::LoadTorrentParams> BitTorrent::DBResumeDataStorage::lo
         return std::nullopt;
     }
 
-    LoadTorrentParams resumeData;
-    resumeData.restored = true;
-    resumeData.name = query.value(DB_COLUMN_NAME.name).toString();
-    resumeData.category = query.value(DB_COLUMN_CATEGORY.name).toString();
-    const QString tagsData = query.value(DB_COLUMN_TAGS.name).toString();
-    if (!tagsData.isEmpty())
-    {
-        const QStringList tagList = tagsData.split(QLatin1Char(','));
-        resumeData.tags.insert(tagList.cbegin(), tagList.cend());
-    }
-    resumeData.savePath = Profile::instance()->fromPortablePath(
-                Utils::Fs::toUniformPath(query.value(DB_COLUMN_TARGET_SAVE_PATH.name).toString()));
-    resumeData.hasSeedStatus = query.value(DB_COLUMN_HAS_SEED_STATUS.name).toBool();
-    resumeData.firstLastPiecePriority = query.value(DB_COLUMN_HAS_OUTER_PIECES_PRIORITY.name).toBool();
-    resumeData.ratioLimit = query.value(DB_COLUMN_RATIO_LIMIT.name).toInt() / 1000.0;
-    resumeData.seedingTimeLimit = query.value(DB_COLUMN_SEEDING_TIME_LIMIT.name).toInt();
-    resumeData.contentLayout = Utils::String::toEnum<TorrentContentLayout>(
-                query.value(DB_COLUMN_CONTENT_LAYOUT.name).toString(), TorrentContentLayout::Original);
-    resumeData.operatingMode = Utils::String::toEnum<TorrentOperatingMode>(
-                query.value(DB_COLUMN_OPERATING_MODE.name).toString(), TorrentOperatingMode::AutoManaged);
-    resumeData.stopped = query.value(DB_COLUMN_STOPPED.name).toBool();
-
-    const QByteArray bencodedResumeData = query.value(DB_COLUMN_RESUMEDATA.name).toByteArray();
-    const QByteArray bencodedMetadata = query.value(DB_COLUMN_METADATA.name).toByteArray();
-    const QByteArray allData = ((bencodedMetadata.isEmpty() || bencodedResumeData.isEmpty())
-                                ? bencodedResumeData
-                                : (bencodedResumeData.chopped(1) + bencodedMetadata.mid(1)));
-
-    lt::error_code ec;
-    const lt::bdecode_node root = lt::bdecode(allData, ec);
+    return parseQueryResultRow(query);
+}
 
-    lt::add_torrent_params &p = resumeData.ltAddTorrentParams;
+void BitTorrent::DBResumeDataStorage::loadAll(const LoadAllCallback &callback) const
+{
+    // All torrents are fetched using single query, in the same order as `registeredTorrents()` returns them
+    const QString selectTorrentsStatement = makeSelectTorrentsStatement()
+            + QString::fromLatin1(" ORDER BY %1.%2;").arg(quoted(DB_TABLE_TORRENTS), quoted(DB_COLUMN_QUEUE_POSITION.name));
 
-    p = lt::read_resume_data(root, ec);
-    p.save_path = Profile::instance()->fromPortablePath(fromLTString(p.save_path)).toStdString();
+    QSqlQuery query {loadingConnection()};
+    query.setForwardOnly(true);
+    if (!query.exec(selectTorrentsStatement))
+    {
+        LogMsg(tr("Couldn't load resume data of torrents. Error: %1")
+            .arg(query.lastError().text()), Log::CRITICAL);
+        return;
+    }
 
-    return resumeData;
+    while (query.next())
+    {
+        const auto torrentID = TorrentID::fromString(query.value(DB_COLUMN_TORRENT_ID.name).toString());
+        if (!callback(torrentID, parseQueryResultRow(query)))
+            break;
+    }
 }
 
 void BitTorrent::DBResumeDataStorage::store(const TorrentID &id, const LoadTorrentParams &resumeData) const
@@ -329,6 +444,42 @@ void BitTorrent::DBResumeDataStorage::storeQueue(const QVector<TorrentID> &queue
     });
 }
 
+void BitTorrent::DBResumeDataStorage::setSynchronousLevel(const int level) const
+{
+    QMetaObject::invokeMethod(m_asyncWorker, [this, level]()
+    {
+        m_asyncWorker->setSynchronousLevel(level);
+    });
+}
+
+void BitTorrent::DBResumeDataStorage::setWriteBatchSize(const int size) const
+{
+    QMetaObject::invokeMethod(m_asyncWorker, [this, size]()
+    {
+        m_asyncWorker->setWriteBatchSize(size);
+    });
+}
+
+void BitTorrent::DBResumeDataStorage::setWriteBatchDelay(const int delay) const
+{
+    QMetaObject::invokeMethod(m_asyncWorker, [this, delay]()
+    {
+        m_asyncWorker->setWriteBatchDelay(delay);
+    });
+}
+
+QSqlDatabase BitTorrent::DBResumeDataStorage::loadingConnection() const
+{
+    // QSqlDatabase connection can be used only by the thread that created it
+    if (QThread::currentThread() == thread())
+        return QSqlDatabase::database(DB_CONNECTION_NAME);
+
+    if (!m_loadingConnections.hasLocalData())
+        m_loadingConnections.setLocalData(new LoadingConnection(m_dbPath));
+
+    return m_loadingConnections.localData()->database();
+}
+
 void BitTorrent::DBResumeDataStorage::createDB() const
 {
     auto db = QSqlDatabase::database(DB_CONNECTION_NAME);
@@ -381,6 +532,92 @@ void BitTorrent::DBResumeDataStorage::createDB() const
         if (!query.exec(createTableTorrentsQuery))
             throw RuntimeError(query.lastError().text());
 
+        if (!query.exec(makeCreateTableTorrentsMetadataStatement()))
+            throw RuntimeError(query.lastError().text());
+
+        if (!db.commit())
+            throw RuntimeError(db.lastError().text());
+    }
+    catch (const RuntimeError &)
+    {
+        db.rollback();
+        throw;
+    }
+}
+
+int BitTorrent::DBResumeDataStorage::currentDBVersion() const
+{
+    const auto selectDBVersionStatement = QString::fromLatin1("SELECT %1 FROM %2 WHERE %3 = %4;")
+            .arg(quoted(DB_COLUMN_VALUE.name), quoted(DB_TABLE_META), quoted(DB_COLUMN_NAME.name), DB_COLUMN_NAME.placeholder);
+
+    auto db = QSqlDatabase::database(DB_CONNECTION_NAME);
+    QSqlQuery query {db};
+
+    if (!query.prepare(selectDBVersionStatement))
+        throw RuntimeError(query.lastError().text());
+
+    query.bindValue(DB_COLUMN_NAME.placeholder, QString::fromLatin1("version"));
+
+    if (!query.exec())
+        throw RuntimeError(query.lastError().text());
+
+    if (!query.next())
+        throw RuntimeError(tr("Database is corrupted."));
+
+    bool ok;
+    const int dbVersion = query.value(0).toInt(&ok);
+    if (!ok)
+        throw RuntimeError(tr("Database is corrupted."));
+
+    return dbVersion;
+}
+
+void BitTorrent::DBResumeDataStorage::updateDB(const int fromVersion) const
+{
+    Q_ASSERT(fromVersion > 0);
+    Q_ASSERT(fromVersion != DB_VERSION);
+
+    auto db = QSqlDatabase::database(DB_CONNECTION_NAME);
+
+    if (!db.transaction())
+        throw RuntimeError(db.lastError().text());
+
+    QSqlQuery query {db};
+
+    try
+    {
+        if (fromVersion == 1)
+        {
+            // Move metadata out of "torrents" table so it isn't rewritten each time resume data is stored.
+            // Older versions don't check database version so they can't be used with the updated database anymore
+            // (they would load the torrents without metadata), i.e. downgrade isn't supported.
+            if (!query.exec(makeCreateTableTorrentsMetadataStatement()))
+                throw RuntimeError(query.lastError().text());
+
+            const auto copyMetadataStatement = QString::fromLatin1("INSERT INTO %1 (%2, %3) SELECT %2, %4 FROM %5 WHERE %4 IS NOT NULL;")
+                    .arg(quoted(DB_TABLE_TORRENTS_METADATA), quoted(DB_COLUMN_TORRENT_ID.name), quoted(DB_COLUMN_DATA.name)
+                         , quoted(DB_COLUMN_METADATA.name), quoted(DB_TABLE_TORRENTS));
+            if (!query.exec(copyMetadataStatement))
+                throw RuntimeError(query.lastError().text());
+
+            const auto clearLegacyMetadataStatement = QString::fromLatin1("UPDATE %1 SET %2 = NULL;")
+                    .arg(quoted(DB_TABLE_TORRENTS), quoted(DB_COLUMN_METADATA.name));
+            if (!query.exec(clearLegacyMetadataStatement))
+                throw RuntimeError(query.lastError().text());
+        }
+
+        const auto updateMetaVersionStatement = QString::fromLatin1("UPDATE %1 SET %2 = %3 WHERE %4 = %5;")
+                .arg(quoted(DB_TABLE_META), quoted(DB_COLUMN_VALUE.name), DB_COLUMN_VALUE.placeholder
+                     , quoted(DB_COLUMN_NAME.name), DB_COLUMN_NAME.placeholder);
+        if (!query.prepare(updateMetaVersionStatement))
+            throw RuntimeError(query.lastError().text());
+
+        query.bindValue(DB_COLUMN_NAME.placeholder, QString::fromLatin1("version"));
+        query.bindValue(DB_COLUMN_VALUE.placeholder, DB_VERSION);
+
+        if (!query.exec())
+            throw RuntimeError(query.lastError().text());
+
         if (!db.commit())
             throw RuntimeError(db.lastError().text());
     }
@@ -391,26 +628,185 @@ void BitTorrent::DBResumeDataStorage::createDB() const
     }
 }
 
+BitTorrent::DBResumeDataStorage::LoadingConnection::LoadingConnection(const QString &dbPath)
+{
+    static QAtomicInt connectionCounter;
+    m_connectionName = QString::fromLatin1("%1Loading%2")
+            .arg(QLatin1String(DB_CONNECTION_NAME), QString::number(connectionCounter.fetchAndAddRelaxed(1)));
+
+    auto db = QSqlDatabase::addDatabase(QLatin1String("QSQLITE"), m_connectionName);
+    db.setDatabaseName(dbPath);
+    if (!db.open())
+        LogMsg(DBResumeDataStorage::tr("Couldn't open resume data database. Error: %1").arg(db.lastError().text()), Log::CRITICAL);
+}
+
+BitTorrent::DBResumeDataStorage::LoadingConnection::~LoadingConnection()
+{
+    QSqlDatabase::removeDatabase(m_connectionName);
+}
+
+QSqlDatabase BitTorrent::DBResumeDataStorage::LoadingConnection::database() const
+{
+    return QSqlDatabase::database(m_connectionName);
+}
+
 BitTorrent::DBResumeDataStorage::Worker::Worker(const QString &dbPath, const QString &dbConnectionName)
     : m_path {dbPath}
     , m_connectionName {dbConnectionName}
+    , m_flushTimer {new QTimer(this)}
 {
+    m_flushTimer->setSingleShot(true);
+    m_flushTimer->setInterval(1000);
+    connect(m_flushTimer, &QTimer::timeout, this, &Worker::flush);
 }
 
-void BitTorrent::DBResumeDataStorage::Worker::openDatabase() const
+void BitTorrent::DBResumeDataStorage::Worker::openDatabase()
 {
     auto db = QSqlDatabase::addDatabase(QLatin1String("QSQLITE"), m_connectionName);
     db.setDatabaseName(m_path);
     if (!db.open())
         throw RuntimeError(db.lastError().text());
+
+    const auto selectTorrentIDStatement = QString::fromLatin1("SELECT %1 FROM %2;")
+            .arg(quoted(DB_COLUMN_TORRENT_ID.name), quoted(DB_TABLE_TORRENTS_METADATA));
+
+    QSqlQuery query {db};
+    query.setForwardOnly(true);
+    if (!query.exec(selectTorrentIDStatement))
+        throw RuntimeError(query.lastError().text());
+
+    while (query.next())
+        m_storedMetadata.insert(TorrentID::fromString(query.value(0).toString()));
 }
 
-void BitTorrent::DBResumeDataStorage::Worker::closeDatabase() const
+void BitTorrent::DBResumeDataStorage::Worker::closeDatabase()
 {
+    flush();
     QSqlDatabase::removeDatabase(m_connectionName);
 }
 
-void BitTorrent::DBResumeDataStorage::Worker::store(const TorrentID &id, const LoadTorrentParams &resumeData) const
+void BitTorrent::DBResumeDataStorage::Worker::setSynchronousLevel(const int level) const
+{
+    auto db = QSqlDatabase::database(m_connectionName);
+    QSqlQuery query {db};
+    if (!query.exec(QString::fromLatin1("PRAGMA synchronous = %1;").arg(level)))
+    {
+        LogMsg(tr("Couldn't set synchronous level of resume data database. Error: %1")
+            .arg(query.lastError().text()), Log::WARNING);
+    }
+}
+
+void BitTorrent::DBResumeDataStorage::Worker::setWriteBatchSize(const int size)
+{
+    m_writeBatchSize = std::max(1, size);
+    if (pendingCount() >= m_writeBatchSize)
+        flush();
+}
+
+void BitTorrent::DBResumeDataStorage::Worker::setWriteBatchDelay(const int delay)
+{
+    m_flushTimer->setInterval(std::max(0, delay));
+}
+
+void BitTorrent::DBResumeDataStorage::Worker::store(const TorrentID &id, const LoadTorrentParams &resumeData)
+{
+    // Only the latest resume data matters
+    m_pendingStores[id] = resumeData;
+    scheduleFlush();
+}
+
+void BitTorrent::DBResumeDataStorage::Worker::remove(const TorrentID &id)
+{
+    m_pendingStores.remove(id);
+    m_pendingRemovals.insert(id);
+    scheduleFlush();
+}
+
+void BitTorrent::DBResumeDataStorage::Worker::storeQueue(const QVector<TorrentID> &queue)
+{
+    m_pendingQueue = queue;
+    scheduleFlush();
+}
+
+int BitTorrent::DBResumeDataStorage::Worker::pendingCount() const
+{
+    return (m_pendingStores.size() + m_pendingRemovals.size() + (m_pendingQueue ? 1 : 0));
+}
+
+void BitTorrent::DBResumeDataStorage::Worker::scheduleFlush()
+{
+    if (pendingCount() >= m_writeBatchSize)
+        flush();
+    else if (!m_flushTimer->isActive())
+        m_flushTimer->start();
+}
+
+void BitTorrent::DBResumeDataStorage::Worker::flush()
+{
+    m_flushTimer->stop();
+
+    if (pendingCount() == 0)
+        return;
+
+    const QHash<TorrentID, LoadTorrentParams> pendingStores = std::exchange(m_pendingStores, {});
+    const QSet<TorrentID> pendingRemovals = std::exchange(m_pendingRemovals, {});
+    const std::optional<QVector<TorrentID>> pendingQueue = std::exchange(m_pendingQueue, std::nullopt);
+
+    auto db = QSqlDatabase::database(m_connectionName);
+    if (!db.transaction())
+    {
+        LogMsg(tr("Couldn't store resume data. Error: %1").arg(db.lastError().text()), Log::CRITICAL);
+        restorePending(pendingStores, pendingRemovals, pendingQueue);
+        return;
+    }
+
+    QSqlQuery query {db};
+
+    // Removals go first so that the torrent which is removed and then added again is stored
+    for (const TorrentID &torrentID : pendingRemovals)
+        removeTorrent(query, torrentID);
+
+    for (auto it = pendingStores.cbegin(); it != pendingStores.cend(); ++it)
+        storeTorrent(query, it.key(), it.value());
+
+    // Queue positions can be updated only after the torrents are stored
+    if (pendingQueue)
+        storeTorrentsQueue(query, *pendingQueue);
+
+    if (!db.commit())
+    {
+        LogMsg(tr("Couldn't store resume data. Error: %1").arg(db.lastError().text()), Log::CRITICAL);
+        db.rollback();
+        // We don't know anymore which metadata is actually stored so let it be written again if needed
+        m_storedMetadata.clear();
+        restorePending(pendingStores, pendingRemovals, pendingQueue);
+    }
+}
+
+void BitTorrent::DBResumeDataStorage::Worker::restorePending(const QHash<TorrentID, LoadTorrentParams> &stores
+        , const QSet<TorrentID> &removals, const std::optional<QVector<TorrentID>> &queue)
+{
+    // Put the failed batch back to be written later.
+    // Requests that came after it are newer so they take precedence.
+
+    for (auto it = stores.cbegin(); it != stores.cend(); ++it)
+    {
+        if (!m_pendingStores.contains(it.key()) && !m_pendingRemovals.contains(it.key()))
+            m_pendingStores.insert(it.key(), it.value());
+    }
+
+    // Removals are applied before stores so the torrent added again after removal is still stored
+    for (const TorrentID &torrentID : removals)
+        m_pendingRemovals.insert(torrentID);
+
+    if (!m_pendingQueue)
+        m_pendingQueue = queue;
+
+    // Retry after the regular delay rather than immediately
+    m_flushTimer->start();
+}
+
+void BitTorrent::DBResumeDataStorage::Worker::storeTorrent(QSqlQuery &query, const TorrentID &id, const LoadTorrentParams &resumeData)
 {
     // We need to adjust native libtorrent resume data
     lt::add_torrent_params p = resumeData.ltAddTorrentParams;
@@ -453,7 +849,7 @@ void BitTorrent::DBResumeDataStorage::Worker::store(const TorrentID &id, const L
 
     lt::entry data = lt::write_resume_data(p);
 
-    // metadata is stored in separate column
+    // metadata is stored in separate table and written only once since it never changes
     QByteArray bencodedMetadata;
     if (p.ti)
     {
@@ -465,19 +861,20 @@ void BitTorrent::DBResumeDataStorage::Worker::store(const TorrentID &id, const L
         metadataDict.insert(dataDict.extract("created by"));
         metadataDict.insert(dataDict.extract("comment"));
 
-        try
-        {
-            bencodedMetadata.reserve(512 * 1024);
-            lt::bencode(std::back_inserter(bencodedMetadata), metadata);
-        }
-        catch (const std::exception &err)
+        if (!m_storedMetadata.contains(id))
         {
-            LogMsg(tr("Couldn't save torrent metadata. Error: %1.")
-                   .arg(QString::fromLocal8Bit(err.what())), Log::CRITICAL);
-            return;
+            try
+            {
+                bencodedMetadata.reserve(512 * 1024);
+                lt::bencode(std::back_inserter(bencodedMetadata), metadata);
+            }
+            catch (const std::exception &err)
+            {
+                LogMsg(tr("Couldn't save torrent metadata. Error: %1.")
+                       .arg(QString::fromLocal8Bit(err.what())), Log::CRITICAL);
+                return;
+            }
         }
-
-        columns.append(DB_COLUMN_METADATA);
     }
 
     QByteArray bencodedResumeData;
@@ -486,8 +883,6 @@ void BitTorrent::DBResumeDataStorage::Worker::store(const TorrentID &id, const L
 
     const QString insertTorrentStatement = makeInsertStatement(DB_TABLE_TORRENTS, columns)
             + makeOnConflictUpdateStatement(DB_COLUMN_TORRENT_ID, columns);
-    auto db = QSqlDatabase::database(m_connectionName);
-    QSqlQuery query {db};
 
     try
     {
@@ -508,11 +903,25 @@ void BitTorrent::DBResumeDataStorage::Worker::store(const TorrentID &id, const L
         query.bindValue(DB_COLUMN_OPERATING_MODE.placeholder, Utils::String::fromEnum(resumeData.operatingMode));
         query.bindValue(DB_COLUMN_STOPPED.placeholder, resumeData.stopped);
         query.bindValue(DB_COLUMN_RESUMEDATA.placeholder, bencodedResumeData);
-        if (!bencodedMetadata.isEmpty())
-            query.bindValue(DB_COLUMN_METADATA.placeholder, bencodedMetadata);
 
         if (!query.exec())
             throw RuntimeError(query.lastError().text());
+
+        if (!bencodedMetadata.isEmpty())
+        {
+            const QString insertMetadataStatement = makeInsertStatement(DB_TABLE_TORRENTS_METADATA, {DB_COLUMN_TORRENT_ID, DB_COLUMN_DATA})
+                    + QString::fromLatin1(" ON CONFLICT (%1) DO NOTHING").arg(quoted(DB_COLUMN_TORRENT_ID.name));
+            if (!query.prepare(insertMetadataStatement))
+                throw RuntimeError(query.lastError().text());
+
+            query.bindValue(DB_COLUMN_TORRENT_ID.placeholder, id.toString());
+            query.bindValue(DB_COLUMN_DATA.placeholder, bencodedMetadata);
+
+            if (!query.exec())
+                throw RuntimeError(query.lastError().text());
+
+            m_storedMetadata.insert(id);
+        }
     }
     catch (const RuntimeError &err)
     {
@@ -521,22 +930,23 @@ void BitTorrent::DBResumeDataStorage::Worker::store(const TorrentID &id, const L
     }
 }
 
-void BitTorrent::DBResumeDataStorage::Worker::remove(const TorrentID &id) const
+void BitTorrent::DBResumeDataStorage::Worker::removeTorrent(QSqlQuery &query, const TorrentID &id)
 {
-    const auto deleteTorrentStatement = QString::fromLatin1("DELETE FROM %1 WHERE %2 = %3;")
-            .arg(quoted(DB_TABLE_TORRENTS), quoted(DB_COLUMN_TORRENT_ID.name), DB_COLUMN_TORRENT_ID.placeholder);
-
-    auto db = QSqlDatabase::database(m_connectionName);
-    QSqlQuery query {db};
+    const auto deleteStatement = QString::fromLatin1("DELETE FROM %1 WHERE %2 = %3;");
 
     try
     {
-        if (!query.prepare(deleteTorrentStatement))
-            throw RuntimeError(query.lastError().text());
+        for (const char *tableName : {DB_TABLE_TORRENTS, DB_TABLE_TORRENTS_METADATA})
+        {
+            if (!query.prepare(deleteStatement.arg(quoted(QLatin1String(tableName)), quoted(DB_COLUMN_TORRENT_ID.name), DB_COLUMN_TORRENT_ID.placeholder)))
+                throw RuntimeError(query.lastError().text());
 
-        query.bindValue(DB_COLUMN_TORRENT_ID.placeholder, id.toString());
-        if (!query.exec())
-            throw RuntimeError(query.lastError().text());
+            query.bindValue(DB_COLUMN_TORRENT_ID.placeholder, id.toString());
+            if (!query.exec())
+                throw RuntimeError(query.lastError().text());
+        }
+
+        m_storedMetadata.remove(id);
     }
     catch (const RuntimeError &err)
     {
@@ -545,42 +955,24 @@ void BitTorrent::DBResumeDataStorage::Worker::remove(const TorrentID &id) const
     }
 }
 
-void BitTorrent::DBResumeDataStorage::Worker::storeQueue(const QVector<TorrentID> &queue) const
+void BitTorrent::DBResumeDataStorage::Worker::storeTorrentsQueue(QSqlQuery &query, const QVector<TorrentID> &queue) const
 {
     const auto updateQueuePosStatement = QString::fromLatin1("UPDATE %1 SET %2 = %3 WHERE %4 = %5;")
             .arg(quoted(DB_TABLE_TORRENTS), quoted(DB_COLUMN_QUEUE_POSITION.name), DB_COLUMN_QUEUE_POSITION.placeholder
                  , quoted(DB_COLUMN_TORRENT_ID.name), DB_COLUMN_TORRENT_ID.placeholder);
 
-    auto db = QSqlDatabase::database(m_connectionName);
-
     try
     {
-        if (!db.transaction())
-            throw RuntimeError(db.lastError().text());
-
-        QSqlQuery query {db};
+        if (!query.prepare(updateQueuePosStatement))
+            throw RuntimeError(query.lastError().text());
 
-        try
+        int pos = 0;
+        for (const TorrentID &torrentID : queue)
         {
-            if (!query.prepare(updateQueuePosStatement))
+            query.bindValue(DB_COLUMN_TORRENT_ID.placeholder, torrentID.toString());
+            query.bindValue(DB_COLUMN_QUEUE_POSITION.placeholder, pos++);
+            if (!query.exec())
                 throw RuntimeError(query.lastError().text());
-
-            int pos = 0;
-            for (const TorrentID &torrentID : queue)
-            {
-                query.bindValue(DB_COLUMN_TORRENT_ID.placeholder, torrentID.toString());
-                query.bindValue(DB_COLUMN_QUEUE_POSITION.placeholder, pos++);
-                if (!query.exec())
-                    throw RuntimeError(query.lastError().text());
-            }
-
-            if (!db.commit())
-                throw RuntimeError(db.lastError().text());
-        }
-        catch (const RuntimeError &)
-        {
-            db.rollback();
-            throw;
         }
     }
     catch (const RuntimeError &err)
@@ -28,8 +28,12 @@
 
 #pragma once
 
+#include <QString>
+#include <QThreadStorage>
+
 #include "resumedatastorage.h"
 
+class QSqlDatabase;
 class QThread;
 
 namespace BitTorrent
@@ -45,15 +49,30 @@ namespace BitTorrent
 
         QVector<TorrentID> registeredTorrents() const override;
         std::optional<LoadTorrentParams> load(const TorrentID &id) const override;
+        void loadAll(const LoadAllCallback &callback) const override;
         void store(const TorrentID &id, const LoadTorrentParams &resumeData) const override;
         void remove(const TorrentID &id) const override;
         void storeQueue(const QVector<TorrentID> &queue) const override;
 
+        // SQLite "synchronous" pragma value (0 - OFF, 1 - NORMAL, 2 - FULL, 3 - EXTRA)
+        void setSynchronousLevel(int level) const;
+        // Pending writes are flushed in a single transaction once their number
+        // reaches the batch size or after the batch delay (in milliseconds) expires
+        void setWriteBatchSize(int size) const;
+        void setWriteBatchDelay(int delay) const;
+
     private:
         void createDB() const;
+        int currentDBVersion() const;
+        void updateDB(int fromVersion) const;
+        QSqlDatabase loadingConnection() const;
 
+        const QString m_dbPath;
         QThread *m_ioThread = nullptr;
 
+        class LoadingConnection;
+        mutable QThreadStorage<LoadingConnection *> m_loadingConnections;
+
         class Worker;
         Worker *m_asyncWorker = nullptr;
     };
@@ -0,0 +1,153 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2021  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "resumedataloader.h"
+
+#include <algorithm>
+
+#include <QElapsedTimer>
+#include <QMutexLocker>
+
+#include "resumedatastorage.h"
+
+BitTorrent::ResumeDataLoader::ResumeDataLoader(const ResumeDataStorage *storage
+        , const QVector<TorrentID> &torrents, const int prefetchLimit)
+    : m_storage {storage}
+    , m_torrents {torrents}
+    , m_prefetchLimit {std::max(1, prefetchLimit)}
+    , m_isLoadAllMode {false}
+{
+    const QMutexLocker locker {&m_mutex};
+    scheduleJobs();
+}
+
+BitTorrent::ResumeDataLoader::ResumeDataLoader(const ResumeDataStorage *storage, const int prefetchLimit)
+    : m_storage {storage}
+    , m_prefetchLimit {std::max(1, prefetchLimit)}
+    , m_isLoadAllMode {true}
+{
+    m_threadPool.setMaxThreadCount(1);
+    m_threadPool.start([this]() { runLoadAllJob(); });
+}
+
+BitTorrent::ResumeDataLoader::~ResumeDataLoader()
+{
+    {
+        // Don't produce results that nobody will take
+        const QMutexLocker locker {&m_mutex};
+        m_nextJobIndex = m_torrents.size();
+        m_isAborted = true;
+        m_resultTaken.wakeAll();
+    }
+
+    m_threadPool.waitForDone();
+}
+
+std::optional<BitTorrent::ResumeDataLoader::Result> BitTorrent::ResumeDataLoader::takeNext()
+{
+    QMutexLocker locker {&m_mutex};
+
+    if (!isResultPending())
+    {
+        QElapsedTimer waitingTimer;
+        waitingTimer.start();
+        while (!isResultPending())
+            m_resultReady.wait(&m_mutex);
+        m_waitingTime += waitingTimer.elapsed();
+    }
+
+    if (!m_results.contains(m_nextResultIndex))
+        return std::nullopt;
+
+    Result result = m_results.take(m_nextResultIndex++);
+    if (m_isLoadAllMode)
+        m_resultTaken.wakeAll();
+    else
+        scheduleJobs();
+
+    return result;
+}
+
+qint64 BitTorrent::ResumeDataLoader::waitingTime() const
+{
+    const QMutexLocker locker {&m_mutex};
+    return m_waitingTime;
+}
+
+// The following functions must be called with `m_mutex` locked
+
+bool BitTorrent::ResumeDataLoader::isResultPending() const
+{
+    if (m_results.contains(m_nextResultIndex))
+        return true;
+
+    return (m_isLoadAllMode ? m_isFinished : (m_nextResultIndex >= m_torrents.size()));
+}
+
+void BitTorrent::ResumeDataLoader::scheduleJobs()
+{
+    while ((m_nextJobIndex < m_torrents.size()) && ((m_nextJobIndex - m_nextResultIndex) < m_prefetchLimit))
+    {
+        const int index = m_nextJobIndex++;
+        m_threadPool.start([this, index]() { runJob(index); });
+    }
+}
+
+// End of functions that must be called with `m_mutex` locked
+
+void BitTorrent::ResumeDataLoader::runJob(const int index)
+{
+    const TorrentID &torrentID = m_torrents.at(index);
+    std::optional<LoadTorrentParams> resumeData = m_storage->load(torrentID);
+
+    const QMutexLocker locker {&m_mutex};
+    m_results.insert(index, {torrentID, std::move(resumeData)});
+    if (index == m_nextResultIndex)
+        m_resultReady.wakeAll();
+}
+
+void BitTorrent::ResumeDataLoader::runLoadAllJob()
+{
+    m_storage->loadAll([this](const TorrentID &torrentID, const std::optional<LoadTorrentParams> &resumeData)
+    {
+        QMutexLocker locker {&m_mutex};
+        while (!m_isAborted && ((m_loadedCount - m_nextResultIndex) >= m_prefetchLimit))
+            m_resultTaken.wait(&m_mutex);
+
+        if (m_isAborted)
+            return false;
+
+        m_results.insert(m_loadedCount++, {torrentID, resumeData});
+        m_resultReady.wakeAll();
+        return true;
+    });
+
+    const QMutexLocker locker {&m_mutex};
+    m_isFinished = true;
+    m_resultReady.wakeAll();
+}
@@ -0,0 +1,95 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2021  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#pragma once
+
+#include <optional>
+
+#include <QHash>
+#include <QMutex>
+#include <QThreadPool>
+#include <QVector>
+#include <QWaitCondition>
+
+#include "infohash.h"
+#include "loadtorrentparams.h"
+
+namespace BitTorrent
+{
+    class ResumeDataStorage;
+
+    // Loads resume data on worker threads and hands the results out
+    // in the original (i.e. queue) order. At most `prefetchLimit` results
+    // are kept ahead of the consumer.
+    class ResumeDataLoader
+    {
+        Q_DISABLE_COPY_MOVE(ResumeDataLoader)
+
+    public:
+        struct Result
+        {
+            TorrentID torrentID;
+            std::optional<LoadTorrentParams> resumeData;
+        };
+
+        // Loads the given torrents one by one using the pool of threads
+        ResumeDataLoader(const ResumeDataStorage *storage, const QVector<TorrentID> &torrents, int prefetchLimit);
+        // Loads all the torrents using `ResumeDataStorage::loadAll()` in a single thread
+        ResumeDataLoader(const ResumeDataStorage *storage, int prefetchLimit);
+        ~ResumeDataLoader();
+
+        // Blocks until the next result is ready. Returns nothing if all results are taken.
+        std::optional<Result> takeNext();
+
+        // Total time spent by the consumer waiting for results, in milliseconds
+        qint64 waitingTime() const;
+
+    private:
+        void scheduleJobs();
+        void runJob(int index);
+        void runLoadAllJob();
+        bool isResultPending() const;
+
+        const ResumeDataStorage *m_storage = nullptr;
+        const QVector<TorrentID> m_torrents;
+        const int m_prefetchLimit;
+        const bool m_isLoadAllMode;
+
+        QThreadPool m_threadPool;
+        mutable QMutex m_mutex;
+        QWaitCondition m_resultReady;
+        QWaitCondition m_resultTaken;
+        QHash<int, Result> m_results;
+        int m_nextJobIndex = 0;
+        int m_nextResultIndex = 0;
+        int m_loadedCount = 0;
+        bool m_isFinished = false;
+        bool m_isAborted = false;
+        qint64 m_waitingTime = 0;
+    };
+}
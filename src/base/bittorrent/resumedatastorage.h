@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include <functional>
 #include <optional>
 
 #include <QtContainerFwd>
@@ -44,10 +45,17 @@ namespace BitTorrent
         Q_DISABLE_COPY_MOVE(ResumeDataStorage)
 
     public:
+        // Returns `false` to stop loading
+        using LoadAllCallback = std::function<bool (const TorrentID &id, const std::optional<LoadTorrentParams> &resumeData)>;
+
         using QObject::QObject;
 
         virtual QVector<TorrentID> registeredTorrents() const = 0;
         virtual std::optional<LoadTorrentParams> load(const TorrentID &id) const = 0;
+        // Loads all registered torrents in the same order as `registeredTorrents()` returns them
+        // and passes each of them to `callback` in the calling thread as soon as it is loaded.
+        // Must be thread-safe.
+        virtual void loadAll(const LoadAllCallback &callback) const = 0;
         virtual void store(const TorrentID &id, const LoadTorrentParams &resumeData) const = 0;
         virtual void remove(const TorrentID &id) const = 0;
         virtual void storeQueue(const QVector<TorrentID> &queue) const = 0;
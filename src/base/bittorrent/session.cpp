@@ -56,6 +56,7 @@
 
 #include <QDebug>
 #include <QDir>
+#include <QElapsedTimer>
 #include <QFile>
 #include <QHostAddress>
 #include <QNetworkAddressEntry>
@@ -84,6 +85,7 @@
 #include "base/utils/net.h"
 #include "base/utils/random.h"
 #include "base/version.h"
+#include "alertpump.h"
 #include "bandwidthscheduler.h"
 #include "bencoderesumedatastorage.h"
 #include "common.h"
@@ -97,6 +99,7 @@
 #include "magneturi.h"
 #include "nativesessionextension.h"
 #include "portforwarderimpl.h"
+#include "resumedataloader.h"
 #include "statistics.h"
 #include "torrentimpl.h"
 #include "tracker.h"
@@ -108,6 +111,20 @@ namespace
     const char PEER_ID[] = "qB";
     const char USER_AGENT[] = "qBittorrent/" QBT_VERSION_2;
 
+    // Number of torrents added to libtorrent between reading the alerts at startup
+    const int STARTUP_ALERTS_READ_INTERVAL = 100;
+    // Max number of torrents whose resume data is loaded ahead of submission at startup
+    const int STARTUP_PREFETCH_LIMIT = 512;
+
+    // Resume data save requests are sent in steps spread over the save interval
+    const int RESUME_DATA_SAVE_STEP_INTERVAL = 1000; // ms
+    const int RESUME_DATA_SAVE_MIN_STEP_SIZE = 10;
+
+    // Time without refresh demand after which the refresh starts slowing down
+    const int REFRESH_DEMAND_TIMEOUT = 10000; // ms
+    // Max refresh interval when nobody consumes the updates
+    const int MAX_IDLE_REFRESH_INTERVAL = 30000; // ms
+
     void torrentQueuePositionUp(const lt::torrent_handle &handle)
     {
         try
@@ -408,6 +425,7 @@ Session::Session(QObject *parent)
     , m_isAltGlobalSpeedLimitEnabled(BITTORRENT_SESSION_KEY("UseAlternativeGlobalSpeedLimit"), false)
     , m_isBandwidthSchedulerEnabled(BITTORRENT_SESSION_KEY("BandwidthSchedulerEnabled"), false)
     , m_saveResumeDataInterval(BITTORRENT_SESSION_KEY("SaveResumeDataInterval"), 60)
+    , m_saveResumeDataTimeout(BITTORRENT_SESSION_KEY("SaveResumeDataTimeout"), 60, lowerLimited(1))
     , m_port(BITTORRENT_SESSION_KEY("Port"), -1)
     , m_networkInterface(BITTORRENT_SESSION_KEY("Interface"))
     , m_networkInterfaceName(BITTORRENT_SESSION_KEY("InterfaceName"))
@@ -443,11 +461,16 @@ Session::Session(QObject *parent)
                         }
                  )
     , m_resumeDataStorageType(BITTORRENT_SESSION_KEY("ResumeDataStorageType"), ResumeDataStorageType::Legacy)
+    , m_resumeDataStorageSyncLevel(BITTORRENT_SESSION_KEY("ResumeDataStorageSyncLevel"), 1, clampValue(0, 3))
+    , m_resumeDataStorageWriteBatchSize(BITTORRENT_SESSION_KEY("ResumeDataStorageWriteBatchSize"), 100, lowerLimited(1))
+    , m_resumeDataStorageWriteBatchDelay(BITTORRENT_SESSION_KEY("ResumeDataStorageWriteBatchDelay"), 1000, lowerLimited(0))
 #if defined(Q_OS_WIN)
     , m_OSMemoryPriority(BITTORRENT_KEY("OSMemoryPriority"), OSMemoryPriority::BelowNormal)
 #endif
+    , m_refreshTimer {new QTimer {this}}
     , m_seedingLimitTimer {new QTimer {this}}
     , m_resumeDataTimer {new QTimer {this}}
+    , m_resumeDataSaveQueueTimer {new QTimer {this}}
     , m_statistics {new Statistics {this}}
     , m_ioThread {new QThread {this}}
     , m_recentErroredTorrentsTimer {new QTimer {this}}
@@ -463,6 +486,14 @@ Session::Session(QObject *parent)
     connect(m_recentErroredTorrentsTimer, &QTimer::timeout
         , this, [this]() { m_recentErroredTorrents.clear(); });
 
+    m_refreshTimer->setSingleShot(true);
+    connect(m_refreshTimer, &QTimer::timeout, this, [this]()
+    {
+        m_nativeSession->post_torrent_updates();
+        m_nativeSession->post_session_stats();
+    });
+    m_refreshDemandTimer.start();
+
     m_seedingLimitTimer->setInterval(10000);
     connect(m_seedingLimitTimer, &QTimer::timeout, this, &Session::processShareLimits);
 
@@ -510,6 +541,8 @@ Session::Session(QObject *parent)
 
     // Regular saving of fastresume data
     connect(m_resumeDataTimer, &QTimer::timeout, this, [this]() { generateResumeData(); });
+    m_resumeDataSaveQueueTimer->setInterval(RESUME_DATA_SAVE_STEP_INTERVAL);
+    connect(m_resumeDataSaveQueueTimer, &QTimer::timeout, this, &Session::processResumeDataSaveQueue);
     const int saveInterval = saveResumeDataInterval();
     if (saveInterval > 0)
     {
@@ -1606,10 +1639,10 @@ void Session::processShareLimits()
 
     // We shouldn't iterate over `m_torrents` in the loop below
     // since `deleteTorrent()` modifies it indirectly
-    const QHash<TorrentID, TorrentImpl *> torrents {m_torrents};
-    for (TorrentImpl *const torrent : torrents)
+    const TorrentRegistry::TorrentSet seeds = m_torrents.torrents(TorrentStatusGroup::Seed);
+    for (TorrentImpl *const torrent : seeds)
     {
-        if (torrent->isSeed() && !torrent->isForced())
+        if (!torrent->isForced())
         {
             if (torrent->ratioLimit() != Torrent::NO_RATIO_LIMIT)
             {
@@ -1747,26 +1780,27 @@ Torrent *Session::findTorrent(const TorrentID &id) const
 
 bool Session::hasActiveTorrents() const
 {
-    return std::any_of(m_torrents.begin(), m_torrents.end(), [](TorrentImpl *torrent)
-    {
-        return TorrentFilter::ActiveTorrent.match(torrent);
-    });
+    return !m_torrents.torrents(TorrentStatusGroup::Active).isEmpty();
 }
 
 bool Session::hasUnfinishedTorrents() const
 {
-    return std::any_of(m_torrents.begin(), m_torrents.end(), [](const TorrentImpl *torrent)
-    {
-        return (!torrent->isSeed() && !torrent->isPaused() && !torrent->isErrored());
-    });
+    return !m_torrents.torrents(TorrentStatusGroup::Unfinished).isEmpty();
 }
 
 bool Session::hasRunningSeed() const
 {
-    return std::any_of(m_torrents.begin(), m_torrents.end(), [](const TorrentImpl *torrent)
-    {
-        return (torrent->isSeed() && !torrent->isPaused());
-    });
+    return !m_torrents.torrents(TorrentStatusGroup::RunningSeed).isEmpty();
+}
+
+int Session::torrentsCount() const
+{
+    return m_torrents.size();
+}
+
+int Session::torrentsCount(const TorrentStatusGroup group) const
+{
+    return m_torrents.torrents(group).size();
 }
 
 void Session::banIP(const QString &ip)
@@ -1977,7 +2011,7 @@ void Session::bottomTorrentsQueuePos(const QVector<TorrentID> &ids)
     saveTorrentsQueue();
 }
 
-void Session::handleTorrentNeedSaveResumeData(const TorrentImpl *torrent)
+void Session::handleTorrentNeedSaveResumeData(TorrentImpl *const torrent)
 {
     if (m_needSaveResumeDataTorrents.empty())
     {
@@ -1988,12 +2022,17 @@ void Session::handleTorrentNeedSaveResumeData(const TorrentImpl *torrent)
                 TorrentImpl *torrent = m_torrents.value(torrentID);
                 if (torrent)
                     torrent->saveResumeData();
+                m_dirtyResumeDataTorrents.remove(torrentID);
             }
             m_needSaveResumeDataTorrents.clear();
         }, Qt::QueuedConnection);
     }
 
     m_needSaveResumeDataTorrents.insert(torrent->id());
+
+    // Don't report the torrents that aren't completely loaded yet
+    if (m_torrents.contains(torrent->id()))
+        emit torrentPropertiesChanged(torrent);
 }
 
 void Session::handleTorrentSaveResumeDataRequested(const TorrentImpl *torrent)
@@ -2012,6 +2051,18 @@ QVector<Torrent *> Session::torrents() const
     return result;
 }
 
+QVector<Torrent *> Session::torrents(const TorrentFilter &filter) const
+{
+    const QVector<TorrentImpl *> torrents = m_torrents.torrents(filter);
+
+    QVector<Torrent *> result;
+    result.reserve(torrents.size());
+    for (TorrentImpl *torrent : torrents)
+        result << torrent;
+
+    return result;
+}
+
 bool Session::addTorrent(const QString &source, const AddTorrentParams &params)
 {
     // `source`: .torrent file path/url or magnet uri
@@ -2364,38 +2415,105 @@ void Session::exportTorrentFile(const TorrentInfo &torrentInfo, const QString &f
 
 void Session::generateResumeData()
 {
-    for (TorrentImpl *const torrent : asConst(m_torrents))
+    // Only torrents reported as having changed resume data are processed.
+    // Torrents left in the queue since the previous run are still in the dirty set.
+    m_resumeDataSaveQueue = m_dirtyResumeDataTorrents.values();
+    if (m_resumeDataSaveQueue.isEmpty())
+        return;
+
+    const int stepCount = std::max(1, (m_resumeDataTimer->interval() / RESUME_DATA_SAVE_STEP_INTERVAL));
+    m_resumeDataSaveStepSize = std::max(RESUME_DATA_SAVE_MIN_STEP_SIZE
+        , static_cast<int>((m_resumeDataSaveQueue.size() + stepCount - 1) / stepCount));
+
+    processResumeDataSaveQueue();
+    if (!m_resumeDataSaveQueue.isEmpty())
+        m_resumeDataSaveQueueTimer->start();
+}
+
+void Session::processResumeDataSaveQueue()
+{
+    int requestedCount = 0;
+    while (!m_resumeDataSaveQueue.isEmpty() && (requestedCount < m_resumeDataSaveStepSize))
     {
-        if (!torrent->isValid()) continue;
+        const TorrentID torrentID = m_resumeDataSaveQueue.takeLast();
+        // It could be already saved by other means
+        if (!m_dirtyResumeDataTorrents.remove(torrentID))
+            continue;
 
-        if (torrent->needSaveResumeData())
-        {
-            torrent->saveResumeData();
-            m_needSaveResumeDataTorrents.remove(torrent->id());
-        }
+        TorrentImpl *const torrent = m_torrents.value(torrentID);
+        if (!torrent || !torrent->isValid())
+            continue;
+
+        torrent->saveResumeData();
+        m_needSaveResumeDataTorrents.remove(torrentID);
+        ++requestedCount;
     }
+
+    if (m_resumeDataSaveQueue.isEmpty())
+        m_resumeDataSaveQueueTimer->stop();
 }
 
 // Called on exit
 void Session::saveResumeData()
 {
+    // Alerts are read synchronously from now on
+    stopAlertPump();
+
     // Pause session
     m_nativeSession->pause();
 
     if (isQueueingSystemEnabled())
         saveTorrentsQueue();
-    generateResumeData();
+
+    m_resumeDataSaveQueueTimer->stop();
+    m_resumeDataSaveQueue.clear();
+    m_dirtyResumeDataTorrents.clear();
+
+    // Only torrents having unsaved changes are processed. They are collected using
+    // single request instead of querying each torrent separately.
+    QSet<TorrentID> dirtyTorrents = m_needSaveResumeDataTorrents;
+    m_needSaveResumeDataTorrents.clear();
+    const std::vector<lt::torrent_status> dirtyStatuses = m_nativeSession->get_torrent_status(
+        [](const lt::torrent_status &status) { return status.need_save_resume; }, {});
+    for (const lt::torrent_status &status : dirtyStatuses)
+    {
+#ifdef QBT_USES_LIBTORRENT2
+        dirtyTorrents.insert(TorrentID::fromInfoHash(status.info_hashes));
+#else
+        dirtyTorrents.insert(TorrentID::fromInfoHash(status.info_hash));
+#endif
+    }
+
+    for (const TorrentID &torrentID : asConst(dirtyTorrents))
+    {
+        TorrentImpl *const torrent = m_torrents.value(torrentID);
+        if (torrent && torrent->isValid())
+            torrent->saveResumeData();
+    }
+
+    const int totalCount = m_numResumeData;
+    if (totalCount == 0)
+        return;
+
+    LogMsg(tr("Saving resume data of %1 torrents...").arg(totalCount));
+    emit resumeDataSaveProgress(0, totalCount);
+
+    const qint64 timeout = saveResumeDataTimeout() * 1000;
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
+    qint64 lastProgressReportTime = 0;
 
     while (m_numResumeData > 0)
     {
-        const std::vector<lt::alert *> alerts = getPendingAlerts(lt::seconds {30});
-        if (alerts.empty())
+        const qint64 remainingTime = timeout - elapsedTimer.elapsed();
+        if (remainingTime <= 0)
         {
-            LogMsg(tr("Error: Aborted saving resume data for %1 outstanding torrents.").arg(QString::number(m_numResumeData))
-                , Log::CRITICAL);
+            LogMsg(tr("Saving resume data timed out. Skipped %1 of %2 torrents.")
+                .arg(QString::number(m_numResumeData), QString::number(totalCount)), Log::CRITICAL);
             break;
         }
 
+        const std::vector<lt::alert *> alerts = getPendingAlerts(lt::milliseconds {std::min<qint64>(remainingTime, 1000)});
         for (const lt::alert *a : alerts)
         {
             switch (a->type())
@@ -2406,6 +2524,14 @@ void Session::saveResumeData()
                 break;
             }
         }
+
+        const int savedCount = totalCount - std::max(0, m_numResumeData);
+        if ((m_numResumeData <= 0) || ((elapsedTimer.elapsed() - lastProgressReportTime) >= 1000))
+        {
+            lastProgressReportTime = elapsedTimer.elapsed();
+            LogMsg(tr("Saved resume data of %1 of %2 torrents").arg(QString::number(savedCount), QString::number(totalCount)));
+            emit resumeDataSaveProgress(savedCount, totalCount);
+        }
     }
 }
 
@@ -2772,6 +2898,16 @@ void Session::setSaveResumeDataInterval(const int value)
     }
 }
 
+int Session::saveResumeDataTimeout() const
+{
+    return m_saveResumeDataTimeout;
+}
+
+void Session::setSaveResumeDataTimeout(const int value)
+{
+    m_saveResumeDataTimeout = value;
+}
+
 int Session::port() const
 {
     return m_port;
@@ -2985,6 +3121,51 @@ void Session::setResumeDataStorageType(const ResumeDataStorageType type)
     m_resumeDataStorageType = type;
 }
 
+int Session::resumeDataStorageSyncLevel() const
+{
+    return m_resumeDataStorageSyncLevel;
+}
+
+void Session::setResumeDataStorageSyncLevel(const int level)
+{
+    if (level == m_resumeDataStorageSyncLevel)
+        return;
+
+    m_resumeDataStorageSyncLevel = level;
+    if (const auto *dbStorage = qobject_cast<DBResumeDataStorage *>(m_resumeDataStorage))
+        dbStorage->setSynchronousLevel(resumeDataStorageSyncLevel());
+}
+
+int Session::resumeDataStorageWriteBatchSize() const
+{
+    return m_resumeDataStorageWriteBatchSize;
+}
+
+void Session::setResumeDataStorageWriteBatchSize(const int size)
+{
+    if (size == m_resumeDataStorageWriteBatchSize)
+        return;
+
+    m_resumeDataStorageWriteBatchSize = size;
+    if (const auto *dbStorage = qobject_cast<DBResumeDataStorage *>(m_resumeDataStorage))
+        dbStorage->setWriteBatchSize(resumeDataStorageWriteBatchSize());
+}
+
+int Session::resumeDataStorageWriteBatchDelay() const
+{
+    return m_resumeDataStorageWriteBatchDelay;
+}
+
+void Session::setResumeDataStorageWriteBatchDelay(const int delay)
+{
+    if (delay == m_resumeDataStorageWriteBatchDelay)
+        return;
+
+    m_resumeDataStorageWriteBatchDelay = delay;
+    if (const auto *dbStorage = qobject_cast<DBResumeDataStorage *>(m_resumeDataStorage))
+        dbStorage->setWriteBatchDelay(resumeDataStorageWriteBatchDelay());
+}
+
 QStringList Session::bannedIPs() const
 {
     return m_bannedIPs;
@@ -3872,16 +4053,19 @@ void Session::handleTorrentSavePathChanged(TorrentImpl *const torrent)
 
 void Session::handleTorrentCategoryChanged(TorrentImpl *const torrent, const QString &oldCategory)
 {
+    m_torrents.updateCategory(torrent);
     emit torrentCategoryChanged(torrent, oldCategory);
 }
 
 void Session::handleTorrentTagAdded(TorrentImpl *const torrent, const QString &tag)
 {
+    m_torrents.updateTags(torrent);
     emit torrentTagAdded(torrent, tag);
 }
 
 void Session::handleTorrentTagRemoved(TorrentImpl *const torrent, const QString &tag)
 {
+    m_torrents.updateTags(torrent);
     emit torrentTagRemoved(torrent, tag);
 }
 
@@ -3890,6 +4074,16 @@ void Session::handleTorrentSavingModeChanged(TorrentImpl *const torrent)
     emit torrentSavingModeChanged(torrent);
 }
 
+bool Session::handleTorrentStatusChanged(TorrentImpl *const torrent)
+{
+    return m_torrents.updateStatus(torrent);
+}
+
+void Session::handleTorrentChangedFieldsPending(TorrentImpl *const torrent)
+{
+    m_pendingUpdateTorrents.insert(torrent->id());
+}
+
 void Session::handleTorrentTrackersAdded(TorrentImpl *const torrent, const QVector<TrackerEntry> &newTrackers)
 {
     for (const TrackerEntry &newTracker : newTrackers)
@@ -3945,11 +4139,13 @@ void Session::handleTorrentMetadataReceived(TorrentImpl *const torrent)
 
 void Session::handleTorrentPaused(TorrentImpl *const torrent)
 {
+    m_torrents.updateStatus(torrent);
     emit torrentPaused(torrent);
 }
 
 void Session::handleTorrentResumed(TorrentImpl *const torrent)
 {
+    m_torrents.updateStatus(torrent);
     emit torrentResumed(torrent);
 }
 
@@ -4123,7 +4319,7 @@ void Session::handleTorrentTrackerWarning(TorrentImpl *const torrent, const QStr
 
 bool Session::hasPerTorrentRatioLimit() const
 {
-    return std::any_of(m_torrents.cbegin(), m_torrents.cend(), [](const TorrentImpl *torrent)
+    return std::any_of(m_torrents.begin(), m_torrents.end(), [](const TorrentImpl *torrent)
     {
         return (torrent->ratioLimit() >= 0);
     });
@@ -4131,7 +4327,7 @@ bool Session::hasPerTorrentRatioLimit() const
 
 bool Session::hasPerTorrentSeedingTimeLimit() const
 {
-    return std::any_of(m_torrents.cbegin(), m_torrents.cend(), [](const TorrentImpl *torrent)
+    return std::any_of(m_torrents.begin(), m_torrents.end(), [](const TorrentImpl *torrent)
     {
         return (torrent->seedingTimeLimit() >= 0);
     });
@@ -4229,7 +4425,11 @@ void Session::startUpTorrents()
     ResumeDataStorage *startupStorage = nullptr;
     if (resumeDataStorageType() == ResumeDataStorageType::SQLite)
     {
-        m_resumeDataStorage = new DBResumeDataStorage(dbPath, this);
+        auto *dbStorage = new DBResumeDataStorage(dbPath, this);
+        dbStorage->setSynchronousLevel(resumeDataStorageSyncLevel());
+        dbStorage->setWriteBatchSize(resumeDataStorageWriteBatchSize());
+        dbStorage->setWriteBatchDelay(resumeDataStorageWriteBatchDelay());
+        m_resumeDataStorage = dbStorage;
 
         if (!dbStorageExists)
         {
@@ -4253,36 +4453,49 @@ void Session::startUpTorrents()
 
     qDebug("Starting up torrents...");
 
-    const QVector<TorrentID> torrents = startupStorage->registeredTorrents();
+    QElapsedTimer startupTimer;
+    startupTimer.start();
+
+    int loadedTorrentsCount = 0;
     int resumedTorrentsCount = 0;
+    qint64 waitingTime = 0;
     QVector<TorrentID> queue;
-    for (const TorrentID &torrentID : torrents)
     {
-        const std::optional<LoadTorrentParams> resumeData = startupStorage->load(torrentID);
-        if (resumeData)
+        // Resume data is read and decoded by the storage in background while
+        // this thread keeps submitting the ready ones to libtorrent
+        ResumeDataLoader resumeDataLoader {startupStorage, STARTUP_PREFETCH_LIMIT};
+        while (const std::optional<ResumeDataLoader::Result> loadResult = resumeDataLoader.takeNext())
         {
-            if (m_resumeDataStorage != startupStorage)
+            ++loadedTorrentsCount;
+            const TorrentID &torrentID = loadResult->torrentID;
+            const std::optional<LoadTorrentParams> &resumeData = loadResult->resumeData;
+            if (resumeData)
             {
-                m_resumeDataStorage->store(torrentID, *resumeData);
-                if (isQueueingSystemEnabled() && !resumeData->hasSeedStatus)
-                    queue.append(torrentID);
-            }
+                if (m_resumeDataStorage != startupStorage)
+                {
+                    m_resumeDataStorage->store(torrentID, *resumeData);
+                    if (isQueueingSystemEnabled() && !resumeData->hasSeedStatus)
+                        queue.append(torrentID);
+                }
 
-            qDebug() << "Starting up torrent" << torrentID.toString() << "...";
-            if (!loadTorrent(*resumeData))
-                LogMsg(tr("Unable to resume torrent '%1'.", "e.g: Unable to resume torrent 'hash'.")
-                           .arg(torrentID.toString()), Log::CRITICAL);
+                qDebug() << "Starting up torrent" << torrentID.toString() << "...";
+                if (!loadTorrent(*resumeData))
+                    LogMsg(tr("Unable to resume torrent '%1'.", "e.g: Unable to resume torrent 'hash'.")
+                               .arg(torrentID.toString()), Log::CRITICAL);
 
-            // process add torrent messages before message queue overflow
-            if ((resumedTorrentsCount % 100) == 0) readAlerts();
+                // process add torrent messages before message queue overflow
+                if ((resumedTorrentsCount % STARTUP_ALERTS_READ_INTERVAL) == 0) readAlerts();
 
-            ++resumedTorrentsCount;
-        }
-        else
-        {
-            LogMsg(tr("Unable to resume torrent '%1'.", "e.g: Unable to resume torrent 'hash'.")
-                       .arg(torrentID.toString()), Log::CRITICAL);
+                ++resumedTorrentsCount;
+            }
+            else
+            {
+                LogMsg(tr("Unable to resume torrent '%1'.", "e.g: Unable to resume torrent 'hash'.")
+                           .arg(torrentID.toString()), Log::CRITICAL);
+            }
         }
+
+        waitingTime = resumeDataLoader.waitingTime();
     }
 
     if (m_resumeDataStorage != startupStorage)
@@ -4294,6 +4507,14 @@ void Session::startUpTorrents()
         if (isQueueingSystemEnabled())
             m_resumeDataStorage->storeQueue(queue);
     }
+
+    const qint64 totalTime = startupTimer.elapsed();
+    LogMsg(tr("Restored %1 of %2 torrents in %3 ms (waiting for resume data: %4 ms)")
+        .arg(QString::number(resumedTorrentsCount), QString::number(loadedTorrentsCount), QString::number(totalTime)
+            , QString::number(waitingTime)));
+
+    // Alerts were read synchronously during startup
+    startAlertPump();
 }
 
 quint64 Session::getAlltimeDL() const
@@ -4310,15 +4531,31 @@ void Session::enqueueRefresh()
 {
     Q_ASSERT(!m_refreshEnqueued);
 
-    QTimer::singleShot(refreshInterval(), this, [this] ()
+    // Refresh with regular rate while someone consumes the updates, otherwise slow down exponentially
+    const int regularInterval = refreshInterval();
+    if (!m_refreshDemandTimer.hasExpired(std::max(REFRESH_DEMAND_TIMEOUT, (3 * regularInterval))))
     {
-        m_nativeSession->post_torrent_updates();
-        m_nativeSession->post_session_stats();
-    });
+        m_currentRefreshInterval = regularInterval;
+    }
+    else
+    {
+        m_currentRefreshInterval = std::min(std::max((2 * m_currentRefreshInterval), regularInterval)
+            , std::max(MAX_IDLE_REFRESH_INTERVAL, regularInterval));
+    }
 
+    m_refreshTimer->start(m_currentRefreshInterval);
     m_refreshEnqueued = true;
 }
 
+void Session::notifyRefreshDemand()
+{
+    m_refreshDemandTimer.start();
+
+    // Don't make the consumer wait for slowed down refresh
+    if (m_refreshTimer->isActive() && (m_refreshTimer->remainingTime() > refreshInterval()))
+        m_refreshTimer->start(0);
+}
+
 void Session::handleIPFilterParsed(const int ruleCount)
 {
     if (m_filterParser)
@@ -4364,11 +4601,76 @@ void Session::setTorrentContentLayout(const TorrentContentLayout value)
 // Read alerts sent by the BitTorrent session
 void Session::readAlerts()
 {
+    // Alert pump is the only one who reads alerts while it is running
+    if (m_alertPump)
+        return;
+
     const std::vector<lt::alert *> alerts = getPendingAlerts();
     for (const lt::alert *a : alerts)
         handleAlert(a);
 }
 
+void Session::startAlertPump()
+{
+    Q_ASSERT(!m_alertPump);
+
+    // Handle everything that is already queued before the pump takes over
+    m_nativeSession->set_alert_notify({});
+    readAlerts();
+
+    m_alertPump = new AlertPump(m_nativeSession
+        , [this](const lt::alert *a) { return handleAlertInline(a); }
+        , [this](const std::vector<lt::alert *> &alerts)
+        {
+            for (const lt::alert *a : alerts)
+                handleAlert(a);
+        }
+        , [this](const std::vector<lt::torrent_status> &statuses) { handleTorrentStatusUpdates(statuses); }
+        , this);
+    m_alertPump->start();
+}
+
+void Session::stopAlertPump()
+{
+    if (!m_alertPump)
+        return;
+
+    m_alertPump->stop();
+    delete m_alertPump;
+    m_alertPump = nullptr;
+}
+
+// Called in alert pump thread so it may handle only the alerts that don't access session state
+bool Session::handleAlertInline(const lt::alert *a)
+{
+    switch (a->type())
+    {
+    case lt::portmap_error_alert::alert_type:
+        handlePortmapWarningAlert(static_cast<const lt::portmap_error_alert*>(a));
+        return true;
+    case lt::portmap_alert::alert_type:
+        handlePortmapAlert(static_cast<const lt::portmap_alert*>(a));
+        return true;
+    case lt::peer_blocked_alert::alert_type:
+        handlePeerBlockedAlert(static_cast<const lt::peer_blocked_alert*>(a));
+        return true;
+    case lt::peer_ban_alert::alert_type:
+        handlePeerBanAlert(static_cast<const lt::peer_ban_alert*>(a));
+        return true;
+    case lt::listen_failed_alert::alert_type:
+        handleListenFailedAlert(static_cast<const lt::listen_failed_alert*>(a));
+        return true;
+    case lt::alerts_dropped_alert::alert_type:
+        handleAlertsDroppedAlert(static_cast<const lt::alerts_dropped_alert *>(a));
+        return true;
+    case lt::socks5_alert::alert_type:
+        handleSocks5Alert(static_cast<const lt::socks5_alert *>(a));
+        return true;
+    default:
+        return false;
+    }
+}
+
 void Session::handleAlert(const lt::alert *a)
 {
     try
@@ -4488,7 +4790,7 @@ void Session::createTorrent(const lt::torrent_handle &nativeHandle)
     const LoadTorrentParams params = m_loadingTorrents.take(torrentID);
 
     auto *const torrent = new TorrentImpl {this, m_nativeSession, nativeHandle, params};
-    m_torrents.insert(torrent->id(), torrent);
+    m_torrents.insert(torrent);
 
     const bool hasMetadata = torrent->hasMetadata();
 
@@ -4901,10 +5203,15 @@ void Session::handleStorageMovedFailedAlert(const lt::storage_moved_failed_alert
 
 void Session::handleStateUpdateAlert(const lt::state_update_alert *p)
 {
-    QVector<Torrent *> updatedTorrents;
-    updatedTorrents.reserve(static_cast<decltype(updatedTorrents)::size_type>(p->status.size()));
+    handleTorrentStatusUpdates(p->status);
+}
 
-    for (const lt::torrent_status &status : p->status)
+void Session::handleTorrentStatusUpdates(const std::vector<lt::torrent_status> &statuses)
+{
+    QHash<Torrent *, TorrentChangedFields> updates;
+    updates.reserve(static_cast<int>(statuses.size()));
+
+    for (const lt::torrent_status &status : statuses)
     {
 #ifdef QBT_USES_LIBTORRENT2
         const auto id = TorrentID::fromInfoHash(status.info_hashes);
@@ -4915,12 +5222,48 @@ void Session::handleStateUpdateAlert(const lt::state_update_alert *p)
         if (!torrent)
             continue;
 
-        torrent->handleStateUpdate(status);
-        updatedTorrents.push_back(torrent);
+        if (status.need_save_resume)
+            m_dirtyResumeDataTorrents.insert(id);
+
+        const TorrentChangedFields torrentChangedFields = torrent->handleStateUpdate(status);
+        if (torrentChangedFields)
+            updates[torrent] |= torrentChangedFields;
+    }
+
+    // libtorrent reports only the torrents which status was changed since the last update
+    // so the changes made by other means (e.g. when handling alerts) are added here
+    for (const TorrentID &id : asConst(m_pendingUpdateTorrents))
+    {
+        TorrentImpl *const torrent = m_torrents.value(id);
+        if (!torrent)
+            continue;
+
+        // it's empty if the torrent was already updated above
+        const TorrentChangedFields torrentChangedFields = torrent->takePendingChangedFields();
+        if (torrentChangedFields)
+            updates[torrent] |= torrentChangedFields;
     }
+    m_pendingUpdateTorrents.clear();
+
+    // Time dependent values (e.g. last activity) of running torrents
+    // change even if nothing is changed in their status
+    for (TorrentImpl *torrent : asConst(m_torrents.torrents(TorrentStatusGroup::Resumed)))
+        updates[torrent] |= TorrentChangedField::Time;
 
-    if (!updatedTorrents.isEmpty())
-        emit torrentsUpdated(updatedTorrents);
+    if (!updates.isEmpty())
+    {
+        QVector<Torrent *> updatedTorrents;
+        updatedTorrents.reserve(updates.size());
+        QVector<TorrentChangedFields> changedFields;
+        changedFields.reserve(updates.size());
+        for (auto it = updates.cbegin(); it != updates.cend(); ++it)
+        {
+            updatedTorrents.push_back(it.key());
+            changedFields.push_back(it.value());
+        }
+
+        emit torrentsUpdated(updatedTorrents, changedFields);
+    }
 
     if (m_refreshEnqueued)
         m_refreshEnqueued = false;
@@ -37,6 +37,7 @@
 #include <libtorrent/fwd.hpp>
 #include <libtorrent/torrent_handle.hpp>
 
+#include <QElapsedTimer>
 #include <QHash>
 #include <QPointer>
 #include <QSet>
@@ -48,7 +49,9 @@
 #include "addtorrentparams.h"
 #include "cachestatus.h"
 #include "sessionstatus.h"
+#include "torrent.h"
 #include "torrentinfo.h"
+#include "torrentregistry.h"
 #include "trackerentry.h"
 
 #if (QT_VERSION < QT_VERSION_CHECK(6, 0, 0))
@@ -64,6 +67,7 @@ class BandwidthScheduler;
 class FileSearcher;
 class FilterParserThread;
 class Statistics;
+class TorrentFilter;
 
 // These values should remain unchanged when adding new items
 // so as not to break the existing user settings.
@@ -88,6 +92,7 @@ namespace Net
 
 namespace BitTorrent
 {
+    class AlertPump;
     class InfoHash;
     class MagnetUri;
     class ResumeDataStorage;
@@ -277,6 +282,9 @@ namespace BitTorrent
         void setAppendExtensionEnabled(bool enabled);
         int refreshInterval() const;
         void setRefreshInterval(int value);
+        // Should be called by consumers of torrent status updates and session statistics
+        // to keep them refreshed with `refreshInterval()` rate. Otherwise refresh slows down.
+        void notifyRefreshDemand();
         bool isPreallocationEnabled() const;
         void setPreallocationEnabled(bool enabled);
         QString torrentExportDirectory() const;
@@ -303,6 +311,9 @@ namespace BitTorrent
 
         int saveResumeDataInterval() const;
         void setSaveResumeDataInterval(int value);
+        // Max time (in seconds) to wait for resume data to be saved on exit
+        int saveResumeDataTimeout() const;
+        void setSaveResumeDataTimeout(int value);
         int port() const;
         void setPort(int port);
         QString networkInterface() const;
@@ -436,6 +447,12 @@ namespace BitTorrent
         void setBannedIPs(const QStringList &newList);
         ResumeDataStorageType resumeDataStorageType() const;
         void setResumeDataStorageType(ResumeDataStorageType type);
+        int resumeDataStorageSyncLevel() const;
+        void setResumeDataStorageSyncLevel(int level);
+        int resumeDataStorageWriteBatchSize() const;
+        void setResumeDataStorageWriteBatchSize(int size);
+        int resumeDataStorageWriteBatchDelay() const;
+        void setResumeDataStorageWriteBatchDelay(int delay);
 #if defined(Q_OS_WIN)
         OSMemoryPriority getOSMemoryPriority() const;
         void setOSMemoryPriority(OSMemoryPriority priority);
@@ -444,9 +461,12 @@ namespace BitTorrent
         void startUpTorrents();
         Torrent *findTorrent(const TorrentID &id) const;
         QVector<Torrent *> torrents() const;
+        QVector<Torrent *> torrents(const TorrentFilter &filter) const;
         bool hasActiveTorrents() const;
         bool hasUnfinishedTorrents() const;
         bool hasRunningSeed() const;
+        int torrentsCount() const;
+        int torrentsCount(TorrentStatusGroup group) const;
         const SessionStatus &status() const;
         const CacheStatus &cacheStatus() const;
         quint64 getAlltimeDL() const;
@@ -473,7 +493,7 @@ namespace BitTorrent
         void bottomTorrentsQueuePos(const QVector<TorrentID> &ids);
 
         // Torrent interface
-        void handleTorrentNeedSaveResumeData(const TorrentImpl *torrent);
+        void handleTorrentNeedSaveResumeData(TorrentImpl *const torrent);
         void handleTorrentSaveResumeDataRequested(const TorrentImpl *torrent);
         void handleTorrentShareLimitChanged(TorrentImpl *const torrent);
         void handleTorrentNameChanged(TorrentImpl *const torrent);
@@ -482,6 +502,8 @@ namespace BitTorrent
         void handleTorrentTagAdded(TorrentImpl *const torrent, const QString &tag);
         void handleTorrentTagRemoved(TorrentImpl *const torrent, const QString &tag);
         void handleTorrentSavingModeChanged(TorrentImpl *const torrent);
+        bool handleTorrentStatusChanged(TorrentImpl *const torrent);
+        void handleTorrentChangedFieldsPending(TorrentImpl *const torrent);
         void handleTorrentMetadataReceived(TorrentImpl *const torrent);
         void handleTorrentPaused(TorrentImpl *const torrent);
         void handleTorrentResumed(TorrentImpl *const torrent);
@@ -512,6 +534,7 @@ namespace BitTorrent
         void loadTorrentFailed(const QString &error);
         void metadataDownloaded(const TorrentInfo &info);
         void recursiveTorrentDownloadPossible(Torrent *torrent);
+        void resumeDataSaveProgress(int savedCount, int totalCount);
         void speedLimitModeChanged(bool alternative);
         void statsUpdated();
         void subcategoriesSupportChanged();
@@ -525,10 +548,13 @@ namespace BitTorrent
         void torrentLoaded(Torrent *torrent);
         void torrentMetadataReceived(Torrent *torrent);
         void torrentPaused(Torrent *torrent);
+        // Some of the persistent torrent properties (e.g. speed limits, download options) are changed
+        void torrentPropertiesChanged(Torrent *torrent);
         void torrentResumed(Torrent *torrent);
         void torrentSavePathChanged(Torrent *torrent);
         void torrentSavingModeChanged(Torrent *torrent);
-        void torrentsUpdated(const QVector<Torrent *> &torrents);
+        // `changedFields` contains changed fields of each torrent from `torrents`
+        void torrentsUpdated(const QVector<Torrent *> &torrents, const QVector<TorrentChangedFields> &changedFields);
         void torrentTagAdded(Torrent *torrent, const QString &tag);
         void torrentTagRemoved(Torrent *torrent, const QString &tag);
         void trackerError(Torrent *torrent, const QString &tracker);
@@ -545,6 +571,7 @@ namespace BitTorrent
         void enqueueRefresh();
         void processShareLimits();
         void generateResumeData();
+        void processResumeDataSaveQueue();
         void handleIPFilterParsed(int ruleCount);
         void handleIPFilterError();
         void handleDownloadFinished(const Net::DownloadResult &result);
@@ -608,10 +635,14 @@ namespace BitTorrent
         void updateSeedingLimitTimer();
         void exportTorrentFile(const TorrentInfo &torrentInfo, const QString &folderPath, const QString &baseName);
 
+        void startAlertPump();
+        void stopAlertPump();
+        bool handleAlertInline(const lt::alert *a);
         void handleAlert(const lt::alert *a);
         void dispatchTorrentAlert(const lt::alert *a);
         void handleAddTorrentAlert(const lt::add_torrent_alert *p);
         void handleStateUpdateAlert(const lt::state_update_alert *p);
+        void handleTorrentStatusUpdates(const std::vector<lt::torrent_status> &statuses);
         void handleMetadataReceivedAlert(const lt::metadata_received_alert *p);
         void handleFileErrorAlert(const lt::file_error_alert *p);
         void handleTorrentRemovedAlert(const lt::torrent_removed_alert *p);
@@ -721,6 +752,7 @@ namespace BitTorrent
         CachedSettingValue<bool> m_isAltGlobalSpeedLimitEnabled;
         CachedSettingValue<bool> m_isBandwidthSchedulerEnabled;
         CachedSettingValue<int> m_saveResumeDataInterval;
+        CachedSettingValue<int> m_saveResumeDataTimeout;
         CachedSettingValue<int> m_port;
         CachedSettingValue<QString> m_networkInterface;
         CachedSettingValue<QString> m_networkInterfaceName;
@@ -746,6 +778,9 @@ namespace BitTorrent
         CachedSettingValue<int> m_peerTurnoverInterval;
         CachedSettingValue<QStringList> m_bannedIPs;
         CachedSettingValue<ResumeDataStorageType> m_resumeDataStorageType;
+        CachedSettingValue<int> m_resumeDataStorageSyncLevel;
+        CachedSettingValue<int> m_resumeDataStorageWriteBatchSize;
+        CachedSettingValue<int> m_resumeDataStorageWriteBatchDelay;
 #if defined(Q_OS_WIN)
         CachedSettingValue<OSMemoryPriority> m_OSMemoryPriority;
 #endif
@@ -760,8 +795,13 @@ namespace BitTorrent
         QVector<TrackerEntry> m_additionalTrackerList;
 
         bool m_refreshEnqueued = false;
+        QTimer *m_refreshTimer = nullptr;
+        QElapsedTimer m_refreshDemandTimer;
+        int m_currentRefreshInterval = 0;
         QTimer *m_seedingLimitTimer = nullptr;
         QTimer *m_resumeDataTimer = nullptr;
+        QTimer *m_resumeDataSaveQueueTimer = nullptr;
+        int m_resumeDataSaveStepSize = 0;
         Statistics *m_statistics = nullptr;
         // IP filtering
         QPointer<FilterParserThread> m_filterParser;
@@ -772,14 +812,20 @@ namespace BitTorrent
         QThread *m_ioThread = nullptr;
         ResumeDataStorage *m_resumeDataStorage = nullptr;
         FileSearcher *m_fileSearcher = nullptr;
+        AlertPump *m_alertPump = nullptr;
 
         QSet<TorrentID> m_downloadedMetadata;
 
-        QHash<TorrentID, TorrentImpl *> m_torrents;
+        TorrentRegistry m_torrents;
         QHash<TorrentID, LoadTorrentParams> m_loadingTorrents;
         QHash<QString, AddTorrentParams> m_downloadedTorrents;
         QHash<TorrentID, RemovingTorrentData> m_removingTorrents;
         QSet<TorrentID> m_needSaveResumeDataTorrents;
+        // Torrents which resume data was changed since it was saved last time (as reported by libtorrent)
+        QSet<TorrentID> m_dirtyResumeDataTorrents;
+        QList<TorrentID> m_resumeDataSaveQueue;
+        // Torrents which have changes to be reported with the next status update
+        QSet<TorrentID> m_pendingUpdateTorrents;
         QStringMap m_categories;
         QSet<QString> m_tags;
 
@@ -29,6 +29,7 @@
 
 #pragma once
 
+#include <QFlags>
 #include <QMetaType>
 #include <QString>
 #include <QtContainerFwd>
@@ -98,6 +99,26 @@ namespace BitTorrent
 
     uint qHash(TorrentState key, uint seed);
 
+    // Groups of torrent properties that can be changed by status update
+    enum class TorrentChangedField
+    {
+        State = 1 << 0,
+        Progress = 1 << 1,
+        Speed = 1 << 2,
+        Peers = 1 << 3,
+        TransferredAmount = 1 << 4,
+        Tracker = 1 << 5,
+        Time = 1 << 6,
+        Availability = 1 << 7,
+        SavePath = 1 << 8,
+        QueuePosition = 1 << 9,
+        Name = 1 << 10,
+        // Torrent is moved to/from some status filter
+        StatusGroup = 1 << 11
+    };
+
+    Q_DECLARE_FLAGS(TorrentChangedFields, TorrentChangedField)
+
     class Torrent : public AbstractFileStorage
     {
     public:
@@ -305,4 +326,5 @@ namespace BitTorrent
     };
 }
 
+Q_DECLARE_OPERATORS_FOR_FLAGS(BitTorrent::TorrentChangedFields)
 Q_DECLARE_METATYPE(BitTorrent::TorrentState)
@@ -32,6 +32,7 @@
 #include <algorithm>
 #include <memory>
 #include <type_traits>
+#include <utility>
 
 #include <libtorrent/address.hpp>
 #include <libtorrent/alert_types.hpp>
@@ -236,6 +237,91 @@ namespace
         status.pieces = params.have_pieces;
         status.verified_pieces = params.verified_pieces;
     }
+
+    TorrentChangedFields compareStatus(const lt::torrent_status &oldStatus, const lt::torrent_status &newStatus)
+    {
+        TorrentChangedFields changedFields;
+
+        if ((newStatus.state != oldStatus.state)
+            || (newStatus.flags != oldStatus.flags)
+            || (newStatus.errc != oldStatus.errc)
+            || (newStatus.has_metadata != oldStatus.has_metadata)
+            || (newStatus.is_seeding != oldStatus.is_seeding)
+            || (newStatus.is_finished != oldStatus.is_finished)
+            || (newStatus.moving_storage != oldStatus.moving_storage))
+        {
+            changedFields |= TorrentChangedField::State;
+        }
+
+        if ((newStatus.total_wanted_done != oldStatus.total_wanted_done)
+            || (newStatus.total_wanted != oldStatus.total_wanted)
+            || (newStatus.total_done != oldStatus.total_done)
+            || (newStatus.num_pieces != oldStatus.num_pieces)
+            || (newStatus.progress_ppm != oldStatus.progress_ppm))
+        {
+            changedFields |= TorrentChangedField::Progress;
+        }
+
+        if ((newStatus.download_payload_rate != oldStatus.download_payload_rate)
+            || (newStatus.upload_payload_rate != oldStatus.upload_payload_rate))
+        {
+            changedFields |= TorrentChangedField::Speed;
+        }
+
+        if ((newStatus.num_seeds != oldStatus.num_seeds)
+            || (newStatus.num_peers != oldStatus.num_peers)
+            || (newStatus.num_complete != oldStatus.num_complete)
+            || (newStatus.num_incomplete != oldStatus.num_incomplete)
+            || (newStatus.list_seeds != oldStatus.list_seeds)
+            || (newStatus.list_peers != oldStatus.list_peers)
+            || (newStatus.num_connections != oldStatus.num_connections)
+            || (newStatus.connections_limit != oldStatus.connections_limit))
+        {
+            changedFields |= TorrentChangedField::Peers;
+        }
+
+        if ((newStatus.all_time_download != oldStatus.all_time_download)
+            || (newStatus.all_time_upload != oldStatus.all_time_upload)
+            || (newStatus.total_payload_download != oldStatus.total_payload_download)
+            || (newStatus.total_payload_upload != oldStatus.total_payload_upload)
+            || (newStatus.total_failed_bytes != oldStatus.total_failed_bytes)
+            || (newStatus.total_redundant_bytes != oldStatus.total_redundant_bytes))
+        {
+            changedFields |= TorrentChangedField::TransferredAmount;
+        }
+
+        if ((newStatus.current_tracker != oldStatus.current_tracker)
+            || (newStatus.next_announce != oldStatus.next_announce))
+        {
+            changedFields |= TorrentChangedField::Tracker;
+        }
+
+        if ((newStatus.active_duration != oldStatus.active_duration)
+            || (newStatus.seeding_duration != oldStatus.seeding_duration)
+            || (newStatus.finished_duration != oldStatus.finished_duration)
+            || (newStatus.last_seen_complete != oldStatus.last_seen_complete)
+            || (newStatus.last_download != oldStatus.last_download)
+            || (newStatus.last_upload != oldStatus.last_upload)
+            || (newStatus.completed_time != oldStatus.completed_time)
+            || (newStatus.added_time != oldStatus.added_time))
+        {
+            changedFields |= TorrentChangedField::Time;
+        }
+
+        if (newStatus.distributed_copies != oldStatus.distributed_copies)
+            changedFields |= TorrentChangedField::Availability;
+
+        if (newStatus.save_path != oldStatus.save_path)
+            changedFields |= TorrentChangedField::SavePath;
+
+        if (newStatus.queue_position != oldStatus.queue_position)
+            changedFields |= TorrentChangedField::QueuePosition;
+
+        if (newStatus.name != oldStatus.name)
+            changedFields |= TorrentChangedField::Name;
+
+        return changedFields;
+    }
 }
 
 // TorrentImpl
@@ -1624,9 +1710,14 @@ void TorrentImpl::renameFile(const int index, const QString &path)
     m_nativeHandle.rename_file(m_torrentInfo.nativeIndexes().at(index), Utils::Fs::toNativePath(path).toStdString());
 }
 
-void TorrentImpl::handleStateUpdate(const lt::torrent_status &nativeStatus)
+TorrentChangedFields TorrentImpl::handleStateUpdate(const lt::torrent_status &nativeStatus)
 {
-    updateStatus(nativeStatus);
+    return (updateStatus(nativeStatus) | takePendingChangedFields());
+}
+
+TorrentChangedFields TorrentImpl::takePendingChangedFields()
+{
+    return std::exchange(m_pendingChangedFields, {});
 }
 
 void TorrentImpl::handleMoveStorageJobFinished(const bool hasOutstandingJob)
@@ -2121,16 +2212,30 @@ bool TorrentImpl::useTempPath() const
 
 void TorrentImpl::updateStatus()
 {
-    updateStatus(m_nativeHandle.status());
+    const TorrentChangedFields changedFields = updateStatus(m_nativeHandle.status());
+    if (!changedFields)
+        return;
+
+    m_pendingChangedFields |= changedFields;
+    m_session->handleTorrentChangedFieldsPending(this);
 }
 
-void TorrentImpl::updateStatus(const lt::torrent_status &nativeStatus)
+TorrentChangedFields TorrentImpl::updateStatus(const lt::torrent_status &nativeStatus)
 {
+    TorrentChangedFields changedFields = compareStatus(m_nativeStatus, nativeStatus);
+
+    const TorrentState prevState = m_state;
     m_nativeStatus = nativeStatus;
     updateState();
+    if (m_state != prevState)
+        changedFields |= TorrentChangedField::State;
 
     m_speedMonitor.addSample({nativeStatus.download_payload_rate
                               , nativeStatus.upload_payload_rate});
+    // Average speed (and so ETA) keeps changing until the samples of previous activity are gone
+    const SpeedSampleAvg speedAverage = m_speedMonitor.average();
+    if ((speedAverage.download > 0) || (speedAverage.upload > 0))
+        changedFields |= TorrentChangedField::Speed;
 
     if (hasMetadata())
     {
@@ -2141,6 +2246,11 @@ void TorrentImpl::updateStatus(const lt::torrent_status &nativeStatus)
         else if (isDownloading())
             m_unchecked = true;
     }
+
+    if (m_session->handleTorrentStatusChanged(this))
+        changedFields |= TorrentChangedField::StatusGroup;
+
+    return changedFields;
 }
 
 void TorrentImpl::setRatioLimit(qreal limit)
@@ -231,7 +231,8 @@ namespace BitTorrent
         lt::torrent_handle nativeHandle() const;
 
         void handleAlert(const lt::alert *a);
-        void handleStateUpdate(const lt::torrent_status &nativeStatus);
+        TorrentChangedFields handleStateUpdate(const lt::torrent_status &nativeStatus);
+        TorrentChangedFields takePendingChangedFields();
         void handleTempPathChanged();
         void handleCategorySavePathChanged();
         void handleAppendExtensionToggled();
@@ -245,7 +246,7 @@ namespace BitTorrent
         using EventTrigger = std::function<void ()>;
 
         void updateStatus();
-        void updateStatus(const lt::torrent_status &nativeStatus);
+        TorrentChangedFields updateStatus(const lt::torrent_status &nativeStatus);
         void updateState();
 
         void handleFastResumeRejectedAlert(const lt::fastresume_rejected_alert *p);
@@ -288,6 +289,8 @@ namespace BitTorrent
         lt::torrent_handle m_nativeHandle;
         lt::torrent_status m_nativeStatus;
         TorrentState m_state = TorrentState::Unknown;
+        // Changes made outside of regular status update, they are reported with the next one
+        TorrentChangedFields m_pendingChangedFields;
         TorrentInfo m_torrentInfo;
         QStringList m_filePaths;
         SpeedMonitor m_speedMonitor;
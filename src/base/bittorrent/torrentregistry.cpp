@@ -0,0 +1,343 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2021  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+#include "torrentregistry.h"
+
+#include <cstddef>
+#include <iterator>
+#include <optional>
+
+#include "base/global.h"
+#include "base/torrentfilter.h"
+#include "torrentimpl.h"
+
+using namespace BitTorrent;
+
+namespace
+{
+    // Indexed by TorrentStatusGroup
+    const TorrentFilter *const STATUS_GROUP_FILTERS[] =
+    {
+        &TorrentFilter::DownloadingTorrent,
+        &TorrentFilter::SeedingTorrent,
+        &TorrentFilter::CompletedTorrent,
+        &TorrentFilter::ResumedTorrent,
+        &TorrentFilter::PausedTorrent,
+        &TorrentFilter::ActiveTorrent,
+        &TorrentFilter::InactiveTorrent,
+        &TorrentFilter::StalledTorrent,
+        &TorrentFilter::StalledUploadingTorrent,
+        &TorrentFilter::StalledDownloadingTorrent,
+        &TorrentFilter::CheckingTorrent,
+        &TorrentFilter::ErroredTorrent
+    };
+    static_assert(std::size(STATUS_GROUP_FILTERS) == (static_cast<std::size_t>(TorrentStatusGroup::Errored) + 1));
+
+    quint32 toFlag(const TorrentStatusGroup group)
+    {
+        return (1U << static_cast<int>(group));
+    }
+
+    std::optional<TorrentStatusGroup> toStatusGroup(const TorrentFilter::Type type)
+    {
+        static_assert((TorrentFilter::Errored - TorrentFilter::Downloading) == static_cast<int>(TorrentStatusGroup::Errored));
+
+        if ((type < TorrentFilter::Downloading) || (type > TorrentFilter::Errored))
+            return std::nullopt;
+        return static_cast<TorrentStatusGroup>(type - TorrentFilter::Downloading);
+    }
+
+    quint32 calculateStatusGroups(const TorrentImpl *torrent)
+    {
+        quint32 groups = 0;
+        for (int i = 0; i < static_cast<int>(std::size(STATUS_GROUP_FILTERS)); ++i)
+        {
+            if (STATUS_GROUP_FILTERS[i]->match(torrent))
+                groups |= toFlag(static_cast<TorrentStatusGroup>(i));
+        }
+
+        if (torrent->isSeed())
+        {
+            groups |= toFlag(TorrentStatusGroup::Seed);
+            if (!torrent->isPaused())
+                groups |= toFlag(TorrentStatusGroup::RunningSeed);
+        }
+        else if (!torrent->isPaused() && !torrent->isErrored())
+        {
+            groups |= toFlag(TorrentStatusGroup::Unfinished);
+        }
+
+        return groups;
+    }
+
+    QSet<QString> tagsOf(const TorrentImpl *torrent)
+    {
+        QSet<QString> tags;
+        for (const QString &tag : asConst(torrent->tags()))
+            tags.insert(tag);
+        // Empty key is used for untagged torrents
+        if (tags.isEmpty())
+            tags.insert(QString());
+        return tags;
+    }
+}
+
+TorrentRegistry::TorrentRegistry()
+    : m_statusIndex(static_cast<int>(TorrentStatusGroup::Count))
+{
+}
+
+TorrentRegistry::const_iterator TorrentRegistry::begin() const
+{
+    return m_torrents.cbegin();
+}
+
+TorrentRegistry::const_iterator TorrentRegistry::end() const
+{
+    return m_torrents.cend();
+}
+
+int TorrentRegistry::size() const
+{
+    return m_torrents.size();
+}
+
+bool TorrentRegistry::isEmpty() const
+{
+    return m_torrents.isEmpty();
+}
+
+bool TorrentRegistry::contains(const TorrentID &id) const
+{
+    return m_torrents.contains(id);
+}
+
+TorrentImpl *TorrentRegistry::value(const TorrentID &id) const
+{
+    return m_torrents.value(id);
+}
+
+void TorrentRegistry::insert(TorrentImpl *torrent)
+{
+    Q_ASSERT(!m_torrents.contains(torrent->id()));
+
+    Entry entry;
+    entry.statusGroups = calculateStatusGroups(torrent);
+    entry.category = torrent->category();
+    entry.tags = tagsOf(torrent);
+
+    for (int i = 0; i < m_statusIndex.size(); ++i)
+    {
+        if (entry.statusGroups & toFlag(static_cast<TorrentStatusGroup>(i)))
+            m_statusIndex[i].insert(torrent);
+    }
+    updateIndex(m_categoryIndex, torrent, {}, {entry.category});
+    updateIndex(m_tagIndex, torrent, {}, entry.tags);
+
+    m_torrents.insert(torrent->id(), torrent);
+    m_entries.insert(torrent, entry);
+}
+
+TorrentImpl *TorrentRegistry::take(const TorrentID &id)
+{
+    TorrentImpl *const torrent = m_torrents.take(id);
+    if (!torrent)
+        return nullptr;
+
+    const Entry entry = m_entries.take(torrent);
+    for (int i = 0; i < m_statusIndex.size(); ++i)
+    {
+        if (entry.statusGroups & toFlag(static_cast<TorrentStatusGroup>(i)))
+            m_statusIndex[i].remove(torrent);
+    }
+    updateIndex(m_categoryIndex, torrent, {entry.category}, {});
+    updateIndex(m_tagIndex, torrent, entry.tags, {});
+
+    return torrent;
+}
+
+bool TorrentRegistry::updateStatus(TorrentImpl *torrent)
+{
+    const auto entryIter = m_entries.find(torrent);
+    if (entryIter == m_entries.end())
+        return false;
+
+    const quint32 newGroups = calculateStatusGroups(torrent);
+    const quint32 changedGroups = entryIter->statusGroups ^ newGroups;
+    if (changedGroups == 0)
+        return false;
+
+    for (int i = 0; i < m_statusIndex.size(); ++i)
+    {
+        const quint32 flag = toFlag(static_cast<TorrentStatusGroup>(i));
+        if (!(changedGroups & flag))
+            continue;
+
+        if (newGroups & flag)
+            m_statusIndex[i].insert(torrent);
+        else
+            m_statusIndex[i].remove(torrent);
+    }
+
+    entryIter->statusGroups = newGroups;
+    return true;
+}
+
+void TorrentRegistry::updateCategory(TorrentImpl *torrent)
+{
+    const auto entryIter = m_entries.find(torrent);
+    if (entryIter == m_entries.end())
+        return;
+
+    const QString newCategory = torrent->category();
+    if (newCategory == entryIter->category)
+        return;
+
+    updateIndex(m_categoryIndex, torrent, {entryIter->category}, {newCategory});
+    entryIter->category = newCategory;
+}
+
+void TorrentRegistry::updateTags(TorrentImpl *torrent)
+{
+    const auto entryIter = m_entries.find(torrent);
+    if (entryIter == m_entries.end())
+        return;
+
+    QSet<QString> newTags = tagsOf(torrent);
+    updateIndex(m_tagIndex, torrent, entryIter->tags, newTags);
+    entryIter->tags = std::move(newTags);
+}
+
+const TorrentRegistry::TorrentSet &TorrentRegistry::torrents(const TorrentStatusGroup group) const
+{
+    return m_statusIndex[static_cast<int>(group)];
+}
+
+const TorrentRegistry::TorrentSet &TorrentRegistry::torrentsByCategory(const QString &category) const
+{
+    static const TorrentSet emptySet;
+
+    const auto iter = m_categoryIndex.find(category);
+    return (iter != m_categoryIndex.end()) ? iter.value() : emptySet;
+}
+
+const TorrentRegistry::TorrentSet &TorrentRegistry::torrentsByTag(const QString &tag) const
+{
+    static const TorrentSet emptySet;
+
+    const auto iter = m_tagIndex.find(tag);
+    return (iter != m_tagIndex.end()) ? iter.value() : emptySet;
+}
+
+QVector<TorrentImpl *> TorrentRegistry::torrents(const TorrentFilter &filter) const
+{
+    // Take the smallest of the indexed sets the filter conditions refer to
+    // and check only its torrents against the whole filter
+    const TorrentSet *candidates = nullptr;
+    const auto narrowCandidates = [&candidates](const TorrentSet &torrents)
+    {
+        if (!candidates || (torrents.size() < candidates->size()))
+            candidates = &torrents;
+    };
+
+    TorrentSet idCandidates;
+    if (filter.torrentIDSet() != TorrentFilter::AnyID)
+    {
+        for (const TorrentID &id : asConst(filter.torrentIDSet()))
+        {
+            if (TorrentImpl *torrent = m_torrents.value(id))
+                idCandidates.insert(torrent);
+        }
+        narrowCandidates(idCandidates);
+    }
+
+    if (const std::optional<TorrentStatusGroup> group = toStatusGroup(filter.type()))
+        narrowCandidates(torrents(*group));
+
+    if (!filter.tag().isNull())
+        narrowCandidates(torrentsByTag(filter.tag()));
+
+    TorrentSet categoryCandidates;
+    if (!filter.category().isNull())
+    {
+        const QString category = filter.category();
+        categoryCandidates = torrentsByCategory(category);
+        if (!category.isEmpty())
+        {
+            // Torrents of subcategories may belong to the category as well
+            const QString subcategoryPrefix = category + QLatin1Char('/');
+            for (auto iter = m_categoryIndex.cbegin(); iter != m_categoryIndex.cend(); ++iter)
+            {
+                if (iter.key().startsWith(subcategoryPrefix))
+                    categoryCandidates.unite(iter.value());
+            }
+        }
+        narrowCandidates(categoryCandidates);
+    }
+
+    QVector<TorrentImpl *> result;
+    if (candidates)
+    {
+        for (TorrentImpl *torrent : asConst(*candidates))
+        {
+            if (filter.match(torrent))
+                result.append(torrent);
+        }
+    }
+    else
+    {
+        result.reserve(m_torrents.size());
+        for (TorrentImpl *torrent : asConst(m_torrents))
+            result.append(torrent);
+    }
+
+    return result;
+}
+
+void TorrentRegistry::updateIndex(QHash<QString, TorrentSet> &index, TorrentImpl *torrent
+                                  , const QSet<QString> &oldKeys, const QSet<QString> &newKeys)
+{
+    for (const QString &key : oldKeys)
+    {
+        if (newKeys.contains(key))
+            continue;
+
+        const auto iter = index.find(key);
+        if (iter == index.end())
+            continue;
+
+        iter->remove(torrent);
+        if (iter->isEmpty())
+            index.erase(iter);
+    }
+
+    for (const QString &key : newKeys)
+    {
+        if (!oldKeys.contains(key))
+            index[key].insert(torrent);
+    }
+}
@@ -0,0 +1,123 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2021  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+#pragma once
+
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QtGlobal>
+#include <QVector>
+
+#include "infohash.h"
+
+class TorrentFilter;
+
+namespace BitTorrent
+{
+    class TorrentImpl;
+
+    enum class TorrentStatusGroup
+    {
+        // These match the corresponding TorrentFilter types
+        Downloading,
+        Seeding,
+        Completed,
+        Resumed,
+        Paused,
+        Active,
+        Inactive,
+        Stalled,
+        StalledUploading,
+        StalledDownloading,
+        Checking,
+        Errored,
+
+        // Seed status
+        Seed,
+        RunningSeed,
+        Unfinished,
+
+        Count
+    };
+
+    // Keeps the torrents of the session along with the secondary indexes by status group,
+    // category and tag. The indexes are updated incrementally when the torrent
+    // reports the change of corresponding properties so the lookups cost O(result).
+    class TorrentRegistry
+    {
+        Q_DISABLE_COPY_MOVE(TorrentRegistry)
+
+    public:
+        using TorrentSet = QSet<TorrentImpl *>;
+        using const_iterator = QHash<TorrentID, TorrentImpl *>::const_iterator;
+
+        TorrentRegistry();
+
+        const_iterator begin() const;
+        const_iterator end() const;
+        int size() const;
+        bool isEmpty() const;
+        bool contains(const TorrentID &id) const;
+        TorrentImpl *value(const TorrentID &id) const;
+
+        void insert(TorrentImpl *torrent);
+        TorrentImpl *take(const TorrentID &id);
+
+        // Should be called when the corresponding torrent properties are changed
+        // Returns true if the torrent is moved to/from some status group
+        bool updateStatus(TorrentImpl *torrent);
+        void updateCategory(TorrentImpl *torrent);
+        void updateTags(TorrentImpl *torrent);
+
+        const TorrentSet &torrents(TorrentStatusGroup group) const;
+        // Pass empty string to get uncategorized torrents
+        const TorrentSet &torrentsByCategory(const QString &category) const;
+        // Pass empty string to get untagged torrents
+        const TorrentSet &torrentsByTag(const QString &tag) const;
+
+        QVector<TorrentImpl *> torrents(const TorrentFilter &filter) const;
+
+    private:
+        struct Entry
+        {
+            quint32 statusGroups = 0;
+            QString category;
+            QSet<QString> tags;
+        };
+
+        static void updateIndex(QHash<QString, TorrentSet> &index, TorrentImpl *torrent
+                                , const QSet<QString> &oldKeys, const QSet<QString> &newKeys);
+
+        QHash<TorrentID, TorrentImpl *> m_torrents;
+        QHash<TorrentImpl *, Entry> m_entries;
+
+        QVector<TorrentSet> m_statusIndex;
+        QHash<QString, TorrentSet> m_categoryIndex;
+        QHash<QString, TorrentSet> m_tagIndex;
+    };
+}
@@ -31,14 +31,22 @@
 #include "connection.h"
 
 #include <QTcpSocket>
+#include <QTimer>
 
 #include "base/logger.h"
+#include "eventsource.h"
 #include "irequesthandler.h"
 #include "requestparser.h"
 #include "responsegenerator.h"
 
 using namespace Http;
 
+namespace
+{
+    const int EVENT_STREAM_HEARTBEAT_INTERVAL = 15 * 1000;  // milliseconds
+    const qint64 EVENT_STREAM_MAX_BACKLOG = 8 * 1024 * 1024;  // bytes
+}
+
 Connection::Connection(QTcpSocket *socket, IRequestHandler *requestHandler, QObject *parent)
     : QObject(parent)
     , m_socket(socket)
@@ -66,18 +74,23 @@ Connection::~Connection()
 
 void Connection::read()
 {
-    m_receivedData.append(m_socket->readAll());
-
-    while (!m_receivedData.isEmpty())
+    // no more requests are served once the connection is turned into event stream
+    if (m_eventSource)
     {
-        const RequestParser::ParseResult result = RequestParser::parse(m_receivedData);
+        m_socket->readAll();
+        return;
+    }
 
-        switch (result.status)
+    m_requestParser.addData(m_socket->readAll());
+
+    while (true)
+    {
+        switch (m_requestParser.parse())
         {
         case RequestParser::ParseStatus::Incomplete:
             {
                 const long bufferLimit = RequestParser::MAX_CONTENT_SIZE * 1.1;  // some margin for headers
-                if (m_receivedData.size() > bufferLimit)
+                if (m_requestParser.bufferedSize() > bufferLimit)
                 {
                     Logger::instance()->addMessage(tr("Http request size exceeds limitation, closing socket. Limit: %1, IP: %2")
                         .arg(bufferLimit).arg(m_socket->peerAddress().toString()), Log::WARNING);
@@ -106,17 +119,28 @@ void Connection::read()
 
         case RequestParser::ParseStatus::OK:
             {
+                const Request request = m_requestParser.takeRequest();
                 const Environment env {m_socket->localAddress(), m_socket->localPort(), m_socket->peerAddress(), m_socket->peerPort()};
 
-                Response resp = m_requestHandler->processRequest(result.request, env);
+                Response resp = m_requestHandler->processRequest(request, env);
+
+                if (resp.eventSource)
+                {
+                    // the rest of the connection belongs to the event stream
+                    startEventStream(resp);
+                    return;
+                }
 
-                if (acceptsGzipEncoding(result.request.headers["accept-encoding"]))
-                    resp.headers[HEADER_CONTENT_ENCODING] = "gzip";
+                // content could be already encoded (or found not worth compressing) by the request handler
+                if (resp.isCompressible && !resp.headers.contains(HEADER_CONTENT_ENCODING)
+                    && acceptsGzipEncoding(request.headers[HEADER_ACCEPT_ENCODING]))
+                {
+                    compressContent(resp);
+                }
 
                 resp.headers[HEADER_CONNECTION] = "keep-alive";
 
                 sendResponse(resp);
-                m_receivedData = m_receivedData.mid(result.frameSize);
             }
             break;
 
@@ -132,57 +156,58 @@ void Connection::sendResponse(const Response &response) const
     m_socket->write(toByteArray(response));
 }
 
-bool Connection::hasExpired(const qint64 timeout) const
+void Connection::startEventStream(const Response &response)
 {
-    return (m_socket->bytesAvailable() == 0)
-        && (m_socket->bytesToWrite() == 0)
-        && m_idleTimer.hasExpired(timeout);
-}
+    m_eventSource = response.eventSource;
 
-bool Connection::isClosed() const
-{
-    return (m_socket->state() == QAbstractSocket::UnconnectedState);
+    Response resp = response;
+    resp.headers[HEADER_CONNECTION] = "keep-alive";
+    sendResponse(resp);
+
+    connect(m_eventSource.get(), &EventSource::eventReady, this, &Connection::sendEvent);
+    connect(m_eventSource.get(), &EventSource::finished, m_socket, &QAbstractSocket::disconnectFromHost);
+
+    // comment lines keep idle stream alive through proxies and reveal dead peers
+    auto *heartbeatTimer = new QTimer(this);
+    connect(heartbeatTimer, &QTimer::timeout, this, [this]() { m_socket->write(":\n\n"); });
+    heartbeatTimer->start(EVENT_STREAM_HEARTBEAT_INTERVAL);
 }
 
-bool Connection::acceptsGzipEncoding(QString codings)
+void Connection::sendEvent(const QString &name, const QByteArray &data)
 {
-    // [rfc7231] 5.3.4. Accept-Encoding
-
-    const auto isCodingAvailable = [](const QList<QStringView> &list, const QStringView encoding) -> bool
+    // the client doesn't keep up with the events so there is no point to buffer them
+    if (m_socket->bytesToWrite() > EVENT_STREAM_MAX_BACKLOG)
     {
-        for (const QStringView &str : list)
-        {
-            if (!str.startsWith(encoding))
-                continue;
-
-            // without quality values
-            if (str == encoding)
-                return true;
-
-            // [rfc7231] 5.3.1. Quality Values
-            const QStringView substr = str.mid(encoding.size() + 3);  // ex. skip over "gzip;q="
+        Logger::instance()->addMessage(tr("Http event stream client is too slow, closing socket. IP: %1")
+            .arg(m_socket->peerAddress().toString()), Log::WARNING);
+        m_socket->disconnectFromHost();
+        return;
+    }
 
-            bool ok = false;
-            const double qvalue = substr.toDouble(&ok);
-            if (!ok || (qvalue <= 0))
-                return false;
+    // [html] 9.2.5 Parsing an event stream
+    QByteArray buf;
+    buf.reserve(name.size() + data.size() + 32);
+    if (!name.isEmpty())
+        buf.append("event: ").append(name.toUtf8()).append('\n');
+    for (const QByteArray &line : data.split('\n'))
+        buf.append("data: ").append(line).append('\n');
+    buf.append('\n');
 
-            return true;
-        }
-        return false;
-    };
+    m_socket->write(buf);
+}
 
-    const QList<QStringView> list = QStringView(codings.remove(' ').remove('\t')).split(u',', Qt::SkipEmptyParts);
-    if (list.isEmpty())
+bool Connection::hasExpired(const qint64 timeout) const
+{
+    // event stream is kept alive by heartbeats
+    if (m_eventSource)
         return false;
 
-    const bool canGzip = isCodingAvailable(list, QString::fromLatin1("gzip"));
-    if (canGzip)
-        return true;
-
-    const bool canAny = isCodingAvailable(list, QString::fromLatin1("*"));
-    if (canAny)
-        return true;
+    return (m_socket->bytesAvailable() == 0)
+        && (m_socket->bytesToWrite() == 0)
+        && m_idleTimer.hasExpired(timeout);
+}
 
-    return false;
+bool Connection::isClosed() const
+{
+    return (m_socket->state() == QAbstractSocket::UnconnectedState);
 }
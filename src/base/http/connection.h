@@ -30,13 +30,18 @@
 
 #pragma once
 
+#include <memory>
+
 #include <QElapsedTimer>
 #include <QObject>
 
+#include "requestparser.h"
+
 class QTcpSocket;
 
 namespace Http
 {
+    class EventSource;
     class IRequestHandler;
     struct Response;
 
@@ -53,13 +58,15 @@ namespace Http
         bool isClosed() const;
 
     private:
-        static bool acceptsGzipEncoding(QString codings);
         void read();
         void sendResponse(const Response &response) const;
+        void startEventStream(const Response &response);
+        void sendEvent(const QString &name, const QByteArray &data);
 
         QTcpSocket *m_socket;
         IRequestHandler *m_requestHandler;
-        QByteArray m_receivedData;
+        RequestParser m_requestParser;
         QElapsedTimer m_idleTimer;
+        std::shared_ptr<EventSource> m_eventSource;
     };
 }
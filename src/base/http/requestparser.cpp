@@ -31,9 +31,9 @@
 #include "requestparser.h"
 
 #include <algorithm>
+#include <cctype>
 
 #include <QDebug>
-#include <QRegularExpression>
 #include <QStringList>
 #include <QUrl>
 #include <QUrlQuery>
@@ -50,6 +50,9 @@ namespace
 {
     const QByteArray EOH = QByteArray(CRLF).repeated(2);
 
+    // parsed data is dropped from the buffer once it reaches this size
+    const int COMPACT_THRESHOLD = 64 * 1024;
+
     const QByteArray viewWithoutEndingWith(const QByteArray &in, const QByteArray &str)
     {
         if (in.endsWith(str))
@@ -73,40 +76,113 @@ namespace
 
         return true;
     }
+
+    bool parseHeaderLine(const QByteArray &line, HeaderMap &out)
+    {
+        // [rfc7230] 3.2. Header Fields
+        const int i = line.indexOf(':');
+        if (i <= 0)
+        {
+            qWarning() << Q_FUNC_INFO << "invalid http header:" << line;
+            return false;
+        }
+
+        const QString name = QString::fromLatin1(midView(line, 0, i).trimmed().toLower());
+        const QString value = QString::fromLatin1(midView(line, (i + 1)).trimmed());
+        out[name] = value;
+
+        return true;
+    }
 }
 
-RequestParser::RequestParser()
+void RequestParser::addData(const QByteArray &data)
 {
+    if ((m_pos > 0) && ((m_pos == m_buffer.size()) || (m_pos >= COMPACT_THRESHOLD)))
+    {
+        m_buffer.remove(0, m_pos);
+        m_pos = 0;
+    }
+
+    if (m_buffer.isEmpty())
+        m_buffer = data;
+    else
+        m_buffer.append(data);
 }
 
-RequestParser::ParseResult RequestParser::parse(const QByteArray &data)
+RequestParser::ParseStatus RequestParser::parse()
 {
     // Warning! Header names are converted to lowercase
-    return RequestParser().doParse(data);
+    while (m_state != State::Finished)
+    {
+        ParseStatus status = ParseStatus::BadRequest;
+        switch (m_state)
+        {
+        case State::Headers:
+            status = parseHeaders();
+            break;
+        case State::Body:
+            status = parseBody();
+            break;
+        case State::MultipartPreamble:
+            status = parseMultipartPreamble();
+            break;
+        case State::MultipartPart:
+            status = parseMultipartPart();
+            break;
+        case State::MultipartEpilogue:
+            status = parseMultipartEpilogue();
+            break;
+        default:
+            Q_ASSERT(false);
+            break;
+        }
+
+        if (status != ParseStatus::OK)
+            return status;
+    }
+
+    return ParseStatus::OK;
+}
+
+Request RequestParser::takeRequest()
+{
+    Q_ASSERT(m_state == State::Finished);
+
+    Request request = std::move(m_request);
+    m_request = {};
+    m_state = State::Headers;
+    m_searchOffset = 0;
+    return request;
 }
 
-RequestParser::ParseResult RequestParser::doParse(const QByteArray &data)
+qint64 RequestParser::bufferedSize() const
+{
+    return available();
+}
+
+RequestParser::ParseStatus RequestParser::parseHeaders()
 {
     // we don't handle malformed requests which use double `LF` as delimiter
-    const int headerEnd = data.indexOf(EOH);
+    const int headerEnd = QByteArray::fromRawData(current(), available()).indexOf(EOH, m_searchOffset);
     if (headerEnd < 0)
     {
-        qDebug() << Q_FUNC_INFO << "incomplete request";
-        return {ParseStatus::Incomplete, Request(), 0};
+        // delimiter could be split between reads
+        m_searchOffset = std::max(0, (available() - EOH.size() + 1));
+        return ParseStatus::Incomplete;
     }
 
-    const QString httpHeaders = QString::fromLatin1(data.constData(), headerEnd);
-    if (!parseStartLines(httpHeaders))
-    {
-        qWarning() << Q_FUNC_INFO << "header parsing error";
-        return {ParseStatus::BadRequest, Request(), 0};
-    }
+    if (!parseStartLines(QByteArray::fromRawData(current(), headerEnd)))
+        return fail("header parsing error");
 
-    const int headerLength = headerEnd + EOH.length();
+    consume(headerEnd + EOH.size());
 
     // handle supported methods
     if ((m_request.method == HEADER_REQUEST_METHOD_GET) || (m_request.method == HEADER_REQUEST_METHOD_HEAD))
-        return {ParseStatus::OK, m_request, headerLength};
+    {
+        m_state = State::Finished;
+        return ParseStatus::OK;
+    }
+
     if (m_request.method == HEADER_REQUEST_METHOD_POST)
     {
         const auto parseContentLength = [this]() -> int
@@ -121,56 +197,167 @@ RequestParser::ParseResult RequestParser::doParse(const QByteArray &data)
 
         const int contentLength = parseContentLength();
         if (contentLength < 0)
-        {
-            qWarning() << Q_FUNC_INFO << "bad request: content-length invalid";
-            return {ParseStatus::BadRequest, Request(), 0};
-        }
+            return fail("bad request: content-length invalid");
         if (contentLength > MAX_CONTENT_SIZE)
-        {
-            qWarning() << Q_FUNC_INFO << "bad request: message too long";
-            return {ParseStatus::BadRequest, Request(), 0};
-        }
+            return fail("bad request: message too long");
+
+        m_bodyRemaining = contentLength;
+        m_state = State::Body;
 
-        if (contentLength > 0)
+        // multipart/form-data
+        const QString contentType = m_request.headers[HEADER_CONTENT_TYPE];
+        if ((contentLength > 0) && contentType.startsWith(QLatin1String(CONTENT_TYPE_FORM_DATA), Qt::CaseInsensitive))
         {
-            const QByteArray httpBodyView = midView(data, headerLength, contentLength);
-            if (httpBodyView.length() < contentLength)
-            {
-                qDebug() << Q_FUNC_INFO << "incomplete request";
-                return {ParseStatus::Incomplete, Request(), 0};
-            }
+            // [rfc2046] 5.1.1. Common Syntax
 
-            if (!parsePostMessage(httpBodyView))
-            {
-                qWarning() << Q_FUNC_INFO << "message body parsing error";
-                return {ParseStatus::BadRequest, Request(), 0};
-            }
+            // find boundary delimiter
+            const QLatin1String boundaryFieldName("boundary=");
+            const int idx = contentType.indexOf(boundaryFieldName);
+            if (idx < 0)
+                return fail("Could not find boundary in multipart/form-data header!");
+
+            const QByteArray delimiter = Utils::String::unquote(QStringView(contentType).mid(idx + boundaryFieldName.size())).toLatin1();
+            if (delimiter.isEmpty())
+                return fail("boundary delimiter field empty!");
+
+            // the parts are streamed as they arrive instead of buffering the whole message
+            m_multipartDelimiter = QByteArray(CRLF) + "--" + delimiter;
+            m_state = State::MultipartPreamble;
         }
 
-        return {ParseStatus::OK, m_request, (headerLength + contentLength)};
+        return ParseStatus::OK;
     }
 
     qWarning() << Q_FUNC_INFO << "unsupported request method: " << m_request.method;
-    return {ParseStatus::BadRequest, Request(), 0};  // TODO: SHOULD respond "501 Not Implemented"
+    return ParseStatus::BadRequest;  // TODO: SHOULD respond "501 Not Implemented"
+}
+
+RequestParser::ParseStatus RequestParser::parseBody()
+{
+    if (available() < m_bodyRemaining)
+        return ParseStatus::Incomplete;
+
+    // the body is parsed in place
+    if ((m_bodyRemaining > 0) && !parsePostMessage(QByteArray::fromRawData(current(), m_bodyRemaining)))
+        return fail("message body parsing error");
+
+    consume(m_bodyRemaining);
+    m_state = State::Finished;
+    return ParseStatus::OK;
+}
+
+RequestParser::ParseStatus RequestParser::parseMultipartPreamble()
+{
+    // first "dash-boundary" isn't preceded by CRLF
+    const QByteArray dashBoundary = midView(m_multipartDelimiter, 2) + CRLF;
+    const QByteArray body = QByteArray::fromRawData(current(), availableBody());
+    const int idx = body.indexOf(dashBoundary, m_searchOffset);
+    if (idx < 0)
+    {
+        if (body.size() == m_bodyRemaining)
+            return fail("multipart empty");
+
+        m_searchOffset = std::max(0, (body.size() - dashBoundary.size() + 1));
+        return ParseStatus::Incomplete;
+    }
+
+    consume(idx + dashBoundary.size());
+    m_state = State::MultipartPart;
+    return ParseStatus::OK;
+}
+
+RequestParser::ParseStatus RequestParser::parseMultipartPart()
+{
+    const QByteArray body = QByteArray::fromRawData(current(), availableBody());
+    const int idx = body.indexOf(m_multipartDelimiter, m_searchOffset);
+    // 2 more bytes tell if it is the last part
+    const int delimiterEnd = idx + m_multipartDelimiter.size() + 2;
+    if ((idx < 0) || (body.size() < delimiterEnd))
+    {
+        if (body.size() == m_bodyRemaining)
+            return fail("multipart/form-data format error");
+
+        m_searchOffset = (idx < 0)
+            ? std::max(0, (body.size() - m_multipartDelimiter.size() + 1))
+            : idx;
+        return ParseStatus::Incomplete;
+    }
+
+    // part data ends with CRLF that belongs to the delimiter
+    if (!parseFormData(QByteArray::fromRawData(current(), (idx + 2))))
+        return fail("multipart/form-data part error");
+
+    const QByteArray transportPadding = midView(body, (delimiterEnd - 2), 2);
+    consume(delimiterEnd);
+
+    if (transportPadding == CRLF)
+        return ParseStatus::OK;
+
+    if (transportPadding == "--")
+    {
+        m_state = State::MultipartEpilogue;
+        return ParseStatus::OK;
+    }
+
+    return fail("multipart delimiter error");
+}
+
+RequestParser::ParseStatus RequestParser::parseMultipartEpilogue()
+{
+    if (available() < m_bodyRemaining)
+        return ParseStatus::Incomplete;
+
+    consume(m_bodyRemaining);
+    m_state = State::Finished;
+    return ParseStatus::OK;
+}
+
+RequestParser::ParseStatus RequestParser::fail(const char *reason)
+{
+    qWarning() << Q_FUNC_INFO << reason;
+    return ParseStatus::BadRequest;
+}
+
+int RequestParser::available() const
+{
+    return (m_buffer.size() - m_pos);
+}
+
+int RequestParser::availableBody() const
+{
+    return std::min(available(), m_bodyRemaining);
 }
 
-bool RequestParser::parseStartLines(const QStringView data)
+const char *RequestParser::current() const
+{
+    return (m_buffer.constData() + m_pos);
+}
+
+void RequestParser::consume(const int size)
+{
+    m_pos += size;
+    m_searchOffset = 0;
+    if (m_state != State::Headers)
+        m_bodyRemaining -= size;
+}
+
+bool RequestParser::parseStartLines(const QByteArray &data)
 {
     // we don't handle malformed request which uses `LF` for newline
-    const QList<QStringView> lines = data.split(QString::fromLatin1(CRLF), Qt::SkipEmptyParts);
+    const QVector<QByteArray> lines = splitToViews(data, CRLF, Qt::SkipEmptyParts);
 
     // [rfc7230] 3.2.2. Field Order
-    QStringList requestLines;
-    for (const auto &line : lines)
+    QVector<QByteArray> requestLines;
+    for (const QByteArray &line : lines)
     {
-        if (line.at(0).isSpace() && !requestLines.isEmpty())
+        if (((line.at(0) == ' ') || (line.at(0) == '\t')) && !requestLines.isEmpty())
         {
             // continuation of previous line
-            requestLines.last() += line.toString();
+            requestLines.last() += line;
         }
         else
         {
-            requestLines += line.toString();
+            requestLines += line;
         }
     }
 
@@ -180,7 +367,7 @@ bool RequestParser::parseStartLines(const QStringView data)
     if (!parseRequestLine(requestLines[0]))
         return false;
 
-    for (auto i = ++(requestLines.begin()); i != requestLines.end(); ++i)
+    for (auto i = ++(requestLines.cbegin()); i != requestLines.cend(); ++i)
     {
         if (!parseHeaderLine(*i, m_request.headers))
             return false;
@@ -189,24 +376,36 @@ bool RequestParser::parseStartLines(const QStringView data)
     return true;
 }
 
-bool RequestParser::parseRequestLine(const QString &line)
+bool RequestParser::parseRequestLine(const QByteArray &line)
 {
     // [rfc7230] 3.1.1. Request Line
+    // method SP request-target SP HTTP-version
 
-    const QRegularExpression re(QLatin1String("^([A-Z]+)\\s+(\\S+)\\s+HTTP\\/(\\d\\.\\d)$"));
-    const QRegularExpressionMatch match = re.match(line);
+    const QList<QByteArray> items = line.simplified().split(' ');
+    const auto isValidMethod = [](const QByteArray &method) -> bool
+    {
+        return !method.isEmpty() && std::all_of(method.cbegin(), method.cend(), [](const char c)
+        {
+            return ((c >= 'A') && (c <= 'Z'));
+        });
+    };
+    const auto isValidVersion = [](const QByteArray &version) -> bool
+    {
+        return (version.size() == 8) && version.startsWith("HTTP/")
+            && std::isdigit(static_cast<uchar>(version[5])) && (version[6] == '.') && std::isdigit(static_cast<uchar>(version[7]));
+    };
 
-    if (!match.hasMatch())
+    if ((items.size() != 3) || !isValidMethod(items[0]) || !isValidVersion(items[2]))
     {
         qWarning() << Q_FUNC_INFO << "invalid http header:" << line;
         return false;
     }
 
     // Request Methods
-    m_request.method = match.captured(1);
+    m_request.method = QString::fromLatin1(items[0]);
 
     // Request Target
-    const QByteArray url {match.captured(2).toLatin1()};
+    const QByteArray &url = items[1];
     const int sepPos = url.indexOf('?');
     const QByteArray pathComponent = ((sepPos == -1) ? url : midView(url, 0, sepPos));
 
@@ -235,7 +434,7 @@ bool RequestParser::parseRequestLine(const QString &line)
     }
 
     // HTTP-version
-    m_request.version = match.captured(3);
+    m_request.version = QString::fromLatin1(midView(items[2], 5));
 
     return true;
 }
@@ -262,45 +461,7 @@ bool RequestParser::parsePostMessage(const QByteArray &data)
         return true;
     }
 
-    // multipart/form-data
-    if (contentTypeLower.startsWith(CONTENT_TYPE_FORM_DATA))
-    {
-        // [rfc2046] 5.1.1. Common Syntax
-
-        // find boundary delimiter
-        const QLatin1String boundaryFieldName("boundary=");
-        const int idx = contentType.indexOf(boundaryFieldName);
-        if (idx < 0)
-        {
-            qWarning() << Q_FUNC_INFO << "Could not find boundary in multipart/form-data header!";
-            return false;
-        }
-
-        const QByteArray delimiter = Utils::String::unquote(QStringView(contentType).mid(idx + boundaryFieldName.size())).toLatin1();
-        if (delimiter.isEmpty())
-        {
-            qWarning() << Q_FUNC_INFO << "boundary delimiter field empty!";
-            return false;
-        }
-
-        // split data by "dash-boundary"
-        const QByteArray dashDelimiter = QByteArray("--") + delimiter + CRLF;
-        QVector<QByteArray> multipart = splitToViews(data, dashDelimiter, Qt::SkipEmptyParts);
-        if (multipart.isEmpty())
-        {
-            qWarning() << Q_FUNC_INFO << "multipart empty";
-            return false;
-        }
-
-        // remove the ending delimiter
-        const QByteArray endDelimiter = QByteArray("--") + delimiter + QByteArray("--") + CRLF;
-        multipart.push_back(viewWithoutEndingWith(multipart.takeLast(), endDelimiter));
-
-        return std::all_of(multipart.cbegin(), multipart.cend(), [this](const QByteArray &part)
-        {
-            return this->parseFormData(part);
-        });
-    }
+    // multipart/form-data is streamed part by part
 
     qWarning() << Q_FUNC_INFO << "unknown content type:" << contentType;
     return false;
@@ -317,7 +478,9 @@ bool RequestParser::parseFormData(const QByteArray &data)
     }
 
     const QString headers = QString::fromLatin1(list[0]);
-    const QByteArray payload = viewWithoutEndingWith(list[1], CRLF);
+    // the part is copied out once since the receive buffer is compacted while the rest of the message arrives
+    const QByteArray view = viewWithoutEndingWith(list[1], CRLF);
+    const QByteArray payload {view.constData(), view.size()};
 
     HeaderMap headersMap;
     const QList<QStringView> headerLines = QStringView(headers).split(QString::fromLatin1(CRLF), Qt::SkipEmptyParts);
@@ -34,6 +34,9 @@
 
 namespace Http
 {
+    // Resumable request parser, it keeps its position across the reads so the received data is scanned once.
+    // Multipart messages are parsed part by part as they arrive so only the incomplete part is buffered,
+    // the completed parts are owned by the request.
     class RequestParser
     {
     public:
@@ -44,28 +47,56 @@ namespace Http
             BadRequest
         };
 
-        struct ParseResult
-        {
-            // when `status != ParseStatus::OK`, `request` & `frameSize` are undefined
-            ParseStatus status;
-            Request request;
-            long frameSize;  // http request frame size (bytes)
-        };
-
-        static ParseResult parse(const QByteArray &data);
+        // Appends the received data, parsing continues from where it stopped
+        void addData(const QByteArray &data);
+        // When `ParseStatus::OK` is returned the request can be taken and the parsing of the next request begins.
+        // Parser can't be used anymore after `ParseStatus::BadRequest`.
+        ParseStatus parse();
+        Request takeRequest();
+        // Size of the received data that isn't parsed yet
+        qint64 bufferedSize() const;
 
         static const long MAX_CONTENT_SIZE = 64 * 1024 * 1024;  // 64 MB
 
     private:
-        RequestParser();
+        enum class State
+        {
+            Headers,
+            Body,
+            MultipartPreamble,
+            MultipartPart,
+            MultipartEpilogue,
+            Finished
+        };
+
+        ParseStatus parseHeaders();
+        ParseStatus parseBody();
+        ParseStatus parseMultipartPreamble();
+        ParseStatus parseMultipartPart();
+        ParseStatus parseMultipartEpilogue();
+        ParseStatus fail(const char *reason);
 
-        ParseResult doParse(const QByteArray &data);
-        bool parseStartLines(QStringView data);
-        bool parseRequestLine(const QString &line);
+        bool parseStartLines(const QByteArray &data);
+        bool parseRequestLine(const QByteArray &line);
 
         bool parsePostMessage(const QByteArray &data);
         bool parseFormData(const QByteArray &data);
 
+        // unparsed data (and body data) available in the buffer
+        int available() const;
+        int availableBody() const;
+        const char *current() const;
+        void consume(int size);
+
+        QByteArray m_buffer;
+        // start of unparsed data in the buffer, the rest is relative to it
+        int m_pos = 0;
+        // where to continue looking for the delimiter
+        int m_searchOffset = 0;
+        int m_bodyRemaining = 0;
+        QByteArray m_multipartDelimiter;
+
+        State m_state = State::Headers;
         Request m_request;
     };
 }
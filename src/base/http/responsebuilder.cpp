@@ -50,6 +50,18 @@ void ResponseBuilder::print(const QByteArray &data, const QString &type)
     print_impl(data, type);
 }
 
+void ResponseBuilder::setEventSource(std::shared_ptr<EventSource> eventSource)
+{
+    m_response.eventSource = std::move(eventSource);
+    m_response.headers[HEADER_CONTENT_TYPE] = CONTENT_TYPE_EVENT_STREAM;
+    m_response.headers[HEADER_CACHE_CONTROL] = QLatin1String("no-cache");
+}
+
+void ResponseBuilder::setCompressible(const bool compressible)
+{
+    m_response.isCompressible = compressible;
+}
+
 void ResponseBuilder::clear()
 {
     m_response = Response();
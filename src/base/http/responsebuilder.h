@@ -39,6 +39,8 @@ namespace Http
         void setHeader(const Header &header);
         void print(const QString &text, const QString &type = CONTENT_TYPE_HTML);
         void print(const QByteArray &data, const QString &type = CONTENT_TYPE_HTML);
+        void setEventSource(std::shared_ptr<EventSource> eventSource);
+        void setCompressible(bool compressible);
         void clear();
 
         Response response() const;
@@ -30,15 +30,17 @@
 #include "responsegenerator.h"
 
 #include <QDateTime>
+#include <QList>
+#include <QStringView>
 
 #include "base/http/types.h"
 #include "base/utils/gzip.h"
 
 QByteArray Http::toByteArray(Response response)
 {
-    compressContent(response);
-
-    response.headers[HEADER_CONTENT_LENGTH] = QString::number(response.content.length());
+    // event stream has no end, "304 Not Modified" refers to the length of the cached content
+    if (!response.eventSource && (response.status.code != 304))
+        response.headers[HEADER_CONTENT_LENGTH] = QString::number(response.content.length());
     response.headers[HEADER_DATE] = httpDate();
 
     QByteArray buf;
@@ -80,11 +82,6 @@ QString Http::httpDate()
 
 void Http::compressContent(Response &response)
 {
-    if (response.headers.value(HEADER_CONTENT_ENCODING) != QLatin1String("gzip"))
-        return;
-
-    response.headers.remove(HEADER_CONTENT_ENCODING);
-
     // for very small files, compressing them only wastes cpu cycles
     const int contentSize = response.content.size();
     if (contentSize <= 1024)  // 1 kb
@@ -108,3 +105,46 @@ void Http::compressContent(Response &response)
     response.content = compressedData;
     response.headers[HEADER_CONTENT_ENCODING] = QLatin1String("gzip");
 }
+
+bool Http::acceptsGzipEncoding(QString codings)
+{
+    // [rfc7231] 5.3.4. Accept-Encoding
+
+    const auto isCodingAvailable = [](const QList<QStringView> &list, const QStringView encoding) -> bool
+    {
+        for (const QStringView &str : list)
+        {
+            if (!str.startsWith(encoding))
+                continue;
+
+            // without quality values
+            if (str == encoding)
+                return true;
+
+            // [rfc7231] 5.3.1. Quality Values
+            const QStringView substr = str.mid(encoding.size() + 3);  // ex. skip over "gzip;q="
+
+            bool ok = false;
+            const double qvalue = substr.toDouble(&ok);
+            if (!ok || (qvalue <= 0))
+                return false;
+
+            return true;
+        }
+        return false;
+    };
+
+    const QList<QStringView> list = QStringView(codings.remove(' ').remove('\t')).split(u',', Qt::SkipEmptyParts);
+    if (list.isEmpty())
+        return false;
+
+    const bool canGzip = isCodingAvailable(list, QString::fromLatin1("gzip"));
+    if (canGzip)
+        return true;
+
+    const bool canAny = isCodingAvailable(list, QString::fromLatin1("*"));
+    if (canAny)
+        return true;
+
+    return false;
+}
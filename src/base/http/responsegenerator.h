@@ -39,5 +39,7 @@ namespace Http
 
     QByteArray toByteArray(Response response);
     QString httpDate();
+    bool acceptsGzipEncoding(QString codings);
+    // Compresses the content with gzip if it's worth it
     void compressContent(Response &response);
 }
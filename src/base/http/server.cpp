@@ -32,22 +32,31 @@
 
 #include <algorithm>
 
+#include <QAtomicInt>
+#include <QCoreApplication>
+#include <QMetaObject>
 #include <QNetworkProxy>
+#include <QSet>
 #include <QSslCipher>
 #include <QSslConfiguration>
 #include <QSslSocket>
 #include <QStringList>
+#include <QThread>
 #include <QTimer>
 
 #include "base/algorithm.h"
+#include "base/global.h"
 #include "base/utils/net.h"
 #include "connection.h"
+#include "irequesthandler.h"
+#include "types.h"
 
 namespace
 {
     const int KEEP_ALIVE_DURATION = 7 * 1000;  // milliseconds
     const int CONNECTIONS_LIMIT = 500;
     const int CONNECTIONS_SCAN_INTERVAL = 2;  // seconds
+    const int MAX_WORKER_THREADS = 4;
 
     QList<QSslCipher> safeCipherList()
     {
@@ -63,13 +72,127 @@ namespace
         });
         return safeCiphers;
     }
+
+    // Request handlers (and the Session state they use) aren't thread-safe
+    // so the requests parsed by worker threads are processed in the thread of the context object
+    class RequestHandlerProxy final : public Http::IRequestHandler
+    {
+    public:
+        RequestHandlerProxy(Http::IRequestHandler *requestHandler, QObject *context)
+            : m_requestHandler {requestHandler}
+            , m_context {context}
+        {
+        }
+
+        Http::Response processRequest(const Http::Request &request, const Http::Environment &env) override
+        {
+            if (QThread::currentThread() == m_context->thread())
+                return m_requestHandler->processRequest(request, env);
+
+            Http::Response response {500, QLatin1String("Internal Server Error")};
+            QMetaObject::invokeMethod(m_context, [this, &request, &env, &response]()
+            {
+                response = m_requestHandler->processRequest(request, env);
+            }, Qt::BlockingQueuedConnection);
+            return response;
+        }
+
+    private:
+        Http::IRequestHandler *m_requestHandler = nullptr;
+        QObject *m_context = nullptr;
+    };
 }
 
 using namespace Http;
 
+namespace Http
+{
+    // Owns the connections served by one worker thread
+    class ConnectionPool final : public QObject
+    {
+    public:
+        explicit ConnectionPool(IRequestHandler *requestHandler)
+            : m_requestHandler {requestHandler}
+        {
+        }
+
+        int connectionCount() const
+        {
+            return m_connectionCount.loadRelaxed();
+        }
+
+        // Called in the thread of the server to reserve a slot for the connection before it is added
+        void reserveConnection()
+        {
+            m_connectionCount.ref();
+        }
+
+        // Called in the worker thread
+        void addConnection(const qintptr socketDescriptor, const bool https
+            , const QList<QSslCertificate> &certificates, const QSslKey &key)
+        {
+            QTcpSocket *serverSocket = https ? new QSslSocket : new QTcpSocket;
+            if (!serverSocket->setSocketDescriptor(socketDescriptor))
+            {
+                delete serverSocket;
+                m_connectionCount.deref();
+                return;
+            }
+
+            if (https)
+            {
+                static_cast<QSslSocket *>(serverSocket)->setProtocol(QSsl::SecureProtocols);
+                static_cast<QSslSocket *>(serverSocket)->setPrivateKey(key);
+                static_cast<QSslSocket *>(serverSocket)->setLocalCertificateChain(certificates);
+                static_cast<QSslSocket *>(serverSocket)->setPeerVerifyMode(QSslSocket::VerifyNone);
+                static_cast<QSslSocket *>(serverSocket)->startServerEncryption();
+            }
+
+            auto *c = new Connection(serverSocket, m_requestHandler, this);
+            m_connections.insert(c);
+            connect(serverSocket, &QAbstractSocket::disconnected, this, [c, this]() { removeConnection(c); });
+
+            if (!m_dropConnectionTimer)
+            {
+                m_dropConnectionTimer = new QTimer(this);
+                connect(m_dropConnectionTimer, &QTimer::timeout, this, &ConnectionPool::dropTimedOutConnection);
+                m_dropConnectionTimer->start(CONNECTIONS_SCAN_INTERVAL * 1000);
+            }
+        }
+
+    private:
+        void removeConnection(Connection *connection)
+        {
+            if (!m_connections.remove(connection))
+                return;
+
+            m_connectionCount.deref();
+            connection->deleteLater();
+        }
+
+        void dropTimedOutConnection()
+        {
+            Algorithm::removeIf(m_connections, [this](Connection *connection)
+            {
+                if (!connection->hasExpired(KEEP_ALIVE_DURATION))
+                    return false;
+
+                m_connectionCount.deref();
+                connection->deleteLater();
+                return true;
+            });
+        }
+
+        IRequestHandler *m_requestHandler = nullptr;
+        QSet<Connection *> m_connections;  // for tracking persistent connections
+        QAtomicInt m_connectionCount;
+        QTimer *m_dropConnectionTimer = nullptr;
+    };
+}
+
 Server::Server(IRequestHandler *requestHandler, QObject *parent)
     : QTcpServer(parent)
-    , m_requestHandler(requestHandler)
+    , m_requestHandler(std::make_unique<RequestHandlerProxy>(requestHandler, this))
     , m_https(false)
 {
     setProxy(QNetworkProxy::NoProxy);
@@ -78,57 +201,55 @@ Server::Server(IRequestHandler *requestHandler, QObject *parent)
     sslConf.setCiphers(safeCipherList());
     QSslConfiguration::setDefaultConfiguration(sslConf);
 
-    auto *dropConnectionTimer = new QTimer(this);
-    connect(dropConnectionTimer, &QTimer::timeout, this, &Server::dropTimedOutConnection);
-    dropConnectionTimer->start(CONNECTIONS_SCAN_INTERVAL * 1000);
-}
-
-void Server::incomingConnection(const qintptr socketDescriptor)
-{
-    if (m_connections.size() >= CONNECTIONS_LIMIT) return;
-
-    QTcpSocket *serverSocket;
-    if (m_https)
-        serverSocket = new QSslSocket(this);
-    else
-        serverSocket = new QTcpSocket(this);
-
-    if (!serverSocket->setSocketDescriptor(socketDescriptor))
+    const int workerCount = std::clamp(QThread::idealThreadCount(), 1, MAX_WORKER_THREADS);
+    m_workers.reserve(workerCount);
+    for (int i = 0; i < workerCount; ++i)
     {
-        delete serverSocket;
-        return;
-    }
+        auto *thread = new QThread(this);
+        thread->setObjectName(QString::fromLatin1("HTTP server worker %1").arg(i));
 
-    if (m_https)
-    {
-        static_cast<QSslSocket *>(serverSocket)->setProtocol(QSsl::SecureProtocols);
-        static_cast<QSslSocket *>(serverSocket)->setPrivateKey(m_key);
-        static_cast<QSslSocket *>(serverSocket)->setLocalCertificateChain(m_certificates);
-        static_cast<QSslSocket *>(serverSocket)->setPeerVerifyMode(QSslSocket::VerifyNone);
-        static_cast<QSslSocket *>(serverSocket)->startServerEncryption();
-    }
+        auto *connectionPool = new ConnectionPool(m_requestHandler.get());
+        connectionPool->moveToThread(thread);
+        connect(thread, &QThread::finished, connectionPool, &QObject::deleteLater);
 
-    auto *c = new Connection(serverSocket, m_requestHandler, this);
-    m_connections.insert(c);
-    connect(serverSocket, &QAbstractSocket::disconnected, this, [c, this]() { removeConnection(c); });
+        thread->start();
+        m_workers.append({thread, connectionPool});
+    }
 }
 
-void Server::removeConnection(Connection *connection)
+Server::~Server()
 {
-    m_connections.remove(connection);
-    connection->deleteLater();
+    for (const Worker &worker : asConst(m_workers))
+        worker.thread->quit();
+
+    for (const Worker &worker : asConst(m_workers))
+    {
+        // worker could be waiting for the request to be processed in this thread
+        while (!worker.thread->wait(50))
+            QCoreApplication::removePostedEvents(this, QEvent::MetaCall);
+    }
 }
 
-void Server::dropTimedOutConnection()
+void Server::incomingConnection(const qintptr socketDescriptor)
 {
-    Algorithm::removeIf(m_connections, [](Connection *connection)
+    const auto workerIter = std::min_element(m_workers.cbegin(), m_workers.cend()
+        , [](const Worker &left, const Worker &right)
     {
-        if (!connection->hasExpired(KEEP_ALIVE_DURATION))
-            return false;
-
-        connection->deleteLater();
-        return true;
+        return (left.connectionPool->connectionCount() < right.connectionPool->connectionCount());
     });
+
+    int connectionCount = 0;
+    for (const Worker &worker : asConst(m_workers))
+        connectionCount += worker.connectionPool->connectionCount();
+    if (connectionCount >= CONNECTIONS_LIMIT) return;
+
+    ConnectionPool *connectionPool = workerIter->connectionPool;
+    connectionPool->reserveConnection();
+    QMetaObject::invokeMethod(connectionPool
+        , [connectionPool, socketDescriptor, https = m_https, certificates = m_certificates, key = m_key]()
+    {
+        connectionPool->addConnection(socketDescriptor, https, certificates, key);
+    }, Qt::QueuedConnection);
 }
 
 bool Server::setupHttps(const QByteArray &certificates, const QByteArray &privateKey)
@@ -30,15 +30,19 @@
 
 #pragma once
 
-#include <QSet>
+#include <memory>
+
 #include <QSslCertificate>
 #include <QSslKey>
 #include <QTcpServer>
+#include <QVector>
+
+class QThread;
 
 namespace Http
 {
+    class ConnectionPool;
     class IRequestHandler;
-    class Connection;
 
     class Server final : public QTcpServer
     {
@@ -47,19 +51,24 @@ namespace Http
 
     public:
         explicit Server(IRequestHandler *requestHandler, QObject *parent = nullptr);
+        ~Server() override;
 
         bool setupHttps(const QByteArray &certificates, const QByteArray &privateKey);
         void disableHttps();
 
-    private slots:
-        void dropTimedOutConnection();
-
     private:
+        struct Worker
+        {
+            QThread *thread = nullptr;
+            ConnectionPool *connectionPool = nullptr;
+        };
+
         void incomingConnection(qintptr socketDescriptor) override;
-        void removeConnection(Connection *connection);
 
-        IRequestHandler *m_requestHandler;
-        QSet<Connection *> m_connections;  // for tracking persistent connections
+        // calls the request handler in the thread of the server
+        std::unique_ptr<IRequestHandler> m_requestHandler;
+        // connections are served by the worker threads so slow clients don't block the main thread
+        QVector<Worker> m_workers;
 
         bool m_https;
         QList<QSslCertificate> m_certificates;
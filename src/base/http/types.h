@@ -29,15 +29,21 @@
 
 #pragma once
 
+#include <memory>
+
 #include <QHostAddress>
 #include <QString>
 #include <QVector>
 
 namespace Http
 {
+    class EventSource;
+
     inline const char METHOD_GET[] = "GET";
     inline const char METHOD_POST[] = "POST";
 
+    inline const char HEADER_ACCEPT[] = "accept";
+    inline const char HEADER_ACCEPT_ENCODING[] = "accept-encoding";
     inline const char HEADER_CACHE_CONTROL[] = "cache-control";
     inline const char HEADER_CONNECTION[] = "connection";
     inline const char HEADER_CONTENT_DISPOSITION[] = "content-disposition";
@@ -46,11 +52,14 @@ namespace Http
     inline const char HEADER_CONTENT_SECURITY_POLICY[] = "content-security-policy";
     inline const char HEADER_CONTENT_TYPE[] = "content-type";
     inline const char HEADER_DATE[] = "date";
+    inline const char HEADER_ETAG[] = "etag";
     inline const char HEADER_HOST[] = "host";
+    inline const char HEADER_IF_NONE_MATCH[] = "if-none-match";
     inline const char HEADER_ORIGIN[] = "origin";
     inline const char HEADER_REFERER[] = "referer";
     inline const char HEADER_REFERRER_POLICY[] = "referrer-policy";
     inline const char HEADER_SET_COOKIE[] = "set-cookie";
+    inline const char HEADER_VARY[] = "vary";
     inline const char HEADER_X_CONTENT_TYPE_OPTIONS[] = "x-content-type-options";
     inline const char HEADER_X_FORWARDED_FOR[] = "x-forwarded-for";
     inline const char HEADER_X_FORWARDED_HOST[] = "x-forwarded-host";
@@ -62,7 +71,9 @@ namespace Http
     inline const char HEADER_REQUEST_METHOD_POST[] = "POST";
 
     inline const char CONTENT_TYPE_HTML[] = "text/html";
+    inline const char CONTENT_TYPE_CBOR[] = "application/cbor";
     inline const char CONTENT_TYPE_CSS[] = "text/css";
+    inline const char CONTENT_TYPE_EVENT_STREAM[] = "text/event-stream";
     inline const char CONTENT_TYPE_TXT[] = "text/plain; charset=UTF-8";
     inline const char CONTENT_TYPE_JS[] = "application/javascript";
     inline const char CONTENT_TYPE_JSON[] = "application/json";
@@ -120,6 +131,10 @@ namespace Http
         ResponseStatus status;
         HeaderMap headers;
         QByteArray content;
+        // false if the content shouldn't be compressed by the connection (e.g. it is known not to pay off)
+        bool isCompressible = true;
+        // keeps the connection open to stream the events of the source after the content
+        std::shared_ptr<EventSource> eventSource;
 
         Response(uint code = 200, const QString &text = QLatin1String("OK"))
             : status {code, text}
@@ -67,6 +67,26 @@ TorrentFilter::TorrentFilter(const QString &filter, const TorrentIDSet &idSet, c
     setTypeByName(filter);
 }
 
+TorrentFilter::Type TorrentFilter::type() const
+{
+    return m_type;
+}
+
+const TorrentIDSet &TorrentFilter::torrentIDSet() const
+{
+    return m_idSet;
+}
+
+QString TorrentFilter::category() const
+{
+    return m_category;
+}
+
+QString TorrentFilter::tag() const
+{
+    return m_tag;
+}
+
 bool TorrentFilter::setType(Type type)
 {
     if (m_type != type)
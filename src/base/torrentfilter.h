@@ -84,6 +84,11 @@ public:
     TorrentFilter(Type type, const TorrentIDSet &idSet = AnyID, const QString &category = AnyCategory, const QString &tag = AnyTag);
     TorrentFilter(const QString &filter, const TorrentIDSet &idSet = AnyID, const QString &category = AnyCategory, const QString &tags = AnyTag);
 
+    Type type() const;
+    const TorrentIDSet &torrentIDSet() const;
+    QString category() const;
+    QString tag() const;
+
     bool setType(Type type);
     bool setTypeByName(const QString &filter);
     bool setTorrentIDSet(const TorrentIDSet &idSet);
@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include <QString>
 #include <Qt>
 #include <QtGlobal>
 
@@ -36,8 +37,6 @@
 #include <QCollator>
 #endif
 
-class QString;
-
 namespace Utils::Compare
 {
 #ifdef QBT_USE_QCOLLATOR
@@ -56,6 +55,19 @@ namespace Utils::Compare
             return m_collator.compare(left, right);
         }
 
+        // Sort keys are faster when the same strings are compared many times
+        using SortKey = QCollatorSortKey;
+
+        SortKey sortKey(const QString &str) const
+        {
+            return m_collator.sortKey(str);
+        }
+
+        static int compare(const SortKey &left, const SortKey &right)
+        {
+            return left.compare(right);
+        }
+
     private:
         QCollator m_collator;
     };
@@ -70,6 +82,19 @@ namespace Utils::Compare
         {
             return naturalCompare(left, right, caseSensitivity);
         }
+
+        // Case is folded in advance so keys are compared case sensitively
+        using SortKey = QString;
+
+        SortKey sortKey(const QString &str) const
+        {
+            return (caseSensitivity == Qt::CaseSensitive) ? str : str.toLower();
+        }
+
+        static int compare(const SortKey &left, const SortKey &right)
+        {
+            return naturalCompare(left, right, Qt::CaseSensitive);
+        }
     };
 #endif
 
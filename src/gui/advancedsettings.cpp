@@ -62,6 +62,9 @@ namespace
         // qBittorrent section
         QBITTORRENT_HEADER,
         RESUME_DATA_STORAGE,
+        RESUME_DATA_STORAGE_SYNC_LEVEL,
+        RESUME_DATA_STORAGE_WRITE_BATCH_SIZE,
+        RESUME_DATA_STORAGE_WRITE_BATCH_DELAY,
 #if defined(Q_OS_WIN)
         OS_MEMORY_PRIORITY,
 #endif
@@ -71,6 +74,7 @@ namespace
         NETWORK_IFACE_ADDRESS,
         // behavior
         SAVE_RESUME_DATA_INTERVAL,
+        SAVE_RESUME_DATA_TIMEOUT,
         CONFIRM_RECHECK_TORRENT,
         RECHECK_COMPLETED,
         // UI related
@@ -173,6 +177,9 @@ void AdvancedSettings::saveAdvancedSettings()
     session->setResumeDataStorageType((m_comboBoxResumeDataStorage.currentIndex() == 0)
                                       ? BitTorrent::ResumeDataStorageType::Legacy
                                       : BitTorrent::ResumeDataStorageType::SQLite);
+    session->setResumeDataStorageSyncLevel(m_comboBoxResumeDataStorageSyncLevel.currentIndex());
+    session->setResumeDataStorageWriteBatchSize(m_spinBoxResumeDataStorageWriteBatchSize.value());
+    session->setResumeDataStorageWriteBatchDelay(m_spinBoxResumeDataStorageWriteBatchDelay.value());
 
 #if defined(Q_OS_WIN)
     BitTorrent::OSMemoryPriority prio = BitTorrent::OSMemoryPriority::Normal;
@@ -232,6 +239,8 @@ void AdvancedSettings::saveAdvancedSettings()
     session->setSocketBacklogSize(m_spinBoxSocketBacklogSize.value());
     // Save resume data interval
     session->setSaveResumeDataInterval(m_spinBoxSaveResumeDataInterval.value());
+    // Save resume data timeout
+    session->setSaveResumeDataTimeout(m_spinBoxSaveResumeDataTimeout.value());
     // Outgoing ports
     session->setOutgoingPortsMin(m_spinBoxOutgoingPortsMin.value());
     session->setOutgoingPortsMax(m_spinBoxOutgoingPortsMax.value());
@@ -409,6 +418,22 @@ void AdvancedSettings::loadAdvancedSettings()
     m_comboBoxResumeDataStorage.addItems({tr("Fastresume files"), tr("SQLite database (experimental)")});
     m_comboBoxResumeDataStorage.setCurrentIndex((session->resumeDataStorageType() == BitTorrent::ResumeDataStorageType::Legacy) ? 0 : 1);
     addRow(RESUME_DATA_STORAGE, tr("Resume data storage type (requires restart)"), &m_comboBoxResumeDataStorage);
+    // SQLite synchronous level
+    m_comboBoxResumeDataStorageSyncLevel.addItems({tr("Off"), tr("Normal"), tr("Full"), tr("Extra")});
+    m_comboBoxResumeDataStorageSyncLevel.setCurrentIndex(session->resumeDataStorageSyncLevel());
+    addRow(RESUME_DATA_STORAGE_SYNC_LEVEL, (tr("SQLite database synchronous mode") + ' ' + makeLink("https://www.sqlite.org/pragma.html#pragma_synchronous", "(?)"))
+            , &m_comboBoxResumeDataStorageSyncLevel);
+    // SQLite write batch size
+    m_spinBoxResumeDataStorageWriteBatchSize.setMinimum(1);
+    m_spinBoxResumeDataStorageWriteBatchSize.setMaximum(100000);
+    m_spinBoxResumeDataStorageWriteBatchSize.setValue(session->resumeDataStorageWriteBatchSize());
+    addRow(RESUME_DATA_STORAGE_WRITE_BATCH_SIZE, tr("SQLite database write batch size"), &m_spinBoxResumeDataStorageWriteBatchSize);
+    // SQLite write batch delay
+    m_spinBoxResumeDataStorageWriteBatchDelay.setMinimum(0);
+    m_spinBoxResumeDataStorageWriteBatchDelay.setMaximum(60000);
+    m_spinBoxResumeDataStorageWriteBatchDelay.setSuffix(tr(" ms", " milliseconds"));
+    m_spinBoxResumeDataStorageWriteBatchDelay.setValue(session->resumeDataStorageWriteBatchDelay());
+    addRow(RESUME_DATA_STORAGE_WRITE_BATCH_DELAY, tr("SQLite database write batch delay"), &m_spinBoxResumeDataStorageWriteBatchDelay);
 
 #if defined(Q_OS_WIN)
     m_comboBoxOSMemoryPriority.addItems({tr("Normal"), tr("Below normal"), tr("Medium"), tr("Low"), tr("Very low")});
@@ -554,6 +579,12 @@ void AdvancedSettings::loadAdvancedSettings()
         , this, &AdvancedSettings::updateSaveResumeDataIntervalSuffix);
     updateSaveResumeDataIntervalSuffix(m_spinBoxSaveResumeDataInterval.value());
     addRow(SAVE_RESUME_DATA_INTERVAL, tr("Save resume data interval", "How often the fastresume file is saved."), &m_spinBoxSaveResumeDataInterval);
+    // Save resume data timeout
+    m_spinBoxSaveResumeDataTimeout.setMinimum(1);
+    m_spinBoxSaveResumeDataTimeout.setMaximum(std::numeric_limits<int>::max());
+    m_spinBoxSaveResumeDataTimeout.setSuffix(tr(" s", " seconds"));
+    m_spinBoxSaveResumeDataTimeout.setValue(session->saveResumeDataTimeout());
+    addRow(SAVE_RESUME_DATA_TIMEOUT, tr("Save resume data timeout on exit", "How long to wait for the fastresume files to be saved when exiting."), &m_spinBoxSaveResumeDataTimeout);
     // Outgoing port Min
     m_spinBoxOutgoingPortsMin.setMinimum(0);
     m_spinBoxOutgoingPortsMin.setMaximum(65535);
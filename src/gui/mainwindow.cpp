@@ -1129,6 +1129,8 @@ void MainWindow::showEvent(QShowEvent *e)
     {
         // preparations before showing the window
 
+        BitTorrent::Session::instance()->notifyRefreshDemand();
+
         if (currentTabWidget() == m_transferListWidget)
             m_propertiesWidget->loadDynamicData();
 
@@ -1264,6 +1266,9 @@ void MainWindow::createTorrentTriggered(const QString &path)
 
 bool MainWindow::event(QEvent *e)
 {
+    if ((e->type() == QEvent::WindowStateChange) && !isMinimized())
+        BitTorrent::Session::instance()->notifyRefreshDemand();
+
 #ifndef Q_OS_MACOS
     switch (e->type())
     {
@@ -1600,6 +1605,10 @@ void MainWindow::loadPreferences()
 
 void MainWindow::reloadSessionStats()
 {
+    // Keep refreshing with regular rate while the window is shown
+    if (isVisible() && !isMinimized())
+        BitTorrent::Session::instance()->notifyRefreshDemand();
+
     const BitTorrent::SessionStatus &status = BitTorrent::Session::instance()->status();
 
     // update global information
@@ -294,6 +294,7 @@ void PropertiesWidget::clear()
     m_peerList->clear();
     m_contentFilterLine->clear();
     m_propListModel->model()->clear();
+    m_filesProgressPiecesHave = -1;
 }
 
 BitTorrent::Torrent *PropertiesWidget::getCurrentTorrent() const
@@ -532,7 +533,7 @@ void PropertiesWidget::loadDynamicData()
                 // Load file priorities
                 m_propListModel->model()->updateFilesPriorities(m_torrent->filePriorities());
                 // Update file progress/availability
-                m_propListModel->model()->updateFilesProgress(m_torrent->filesProgress());
+                updateFilesProgress();
                 m_propListModel->model()->updateFilesAvailability(m_torrent->availableFileFractions());
 
                 // Expand single-item folders recursively.
@@ -548,8 +549,10 @@ void PropertiesWidget::loadDynamicData()
             {
                 // Torrent content was loaded already, only make some updates
 
-                m_propListModel->model()->updateFilesProgress(m_torrent->filesProgress());
-                m_propListModel->model()->updateFilesAvailability(m_torrent->availableFileFractions());
+                updateFilesProgress();
+                // Availability requires scanning all the pieces, skip it while it isn't displayed
+                if (!m_ui->filesList->isColumnHidden(TorrentContentModelItem::COL_AVAILABILITY))
+                    m_propListModel->model()->updateFilesAvailability(m_torrent->availableFileFractions());
                 // XXX: We don't update file priorities regularly for performance
                 // reasons. This means that priorities will not be updated if
                 // set from the Web UI.
@@ -563,6 +566,18 @@ void PropertiesWidget::loadDynamicData()
     }
 }
 
+void PropertiesWidget::updateFilesProgress()
+{
+    // File progress is calculated from the downloaded pieces
+    // so it can't change until some piece is finished (or lost when rechecking)
+    const int piecesHave = m_torrent->piecesHave();
+    if ((piecesHave == m_filesProgressPiecesHave) && !m_torrent->isChecking())
+        return;
+
+    m_filesProgressPiecesHave = piecesHave;
+    m_propListModel->model()->updateFilesProgress(m_torrent->filesProgress());
+}
+
 void PropertiesWidget::loadUrlSeeds()
 {
     if (!m_torrent)
@@ -109,6 +109,7 @@ private:
     void applyPriorities();
     void openParentFolder(const QModelIndex &index) const;
     QString getFullPath(const QModelIndex &index) const;
+    void updateFilesProgress();
 
     Ui::PropertiesWidget *m_ui;
     BitTorrent::Torrent *m_torrent;
@@ -124,4 +125,5 @@ private:
     PropTabBar *m_tabBar;
     LineEdit *m_contentFilterLine;
     int m_handleWidth;
+    int m_filesProgressPiecesHave = -1;
 };
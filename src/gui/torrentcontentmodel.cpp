@@ -32,6 +32,7 @@
 
 #include <QFileIconProvider>
 #include <QFileInfo>
+#include <QHash>
 #include <QIcon>
 
 #if defined(Q_OS_WIN)
@@ -186,6 +187,30 @@ namespace
         QMimeDatabase m_db;
     };
 #endif // Q_OS_WIN
+
+    // Returns the folders containing the given items up to the root, subfolders go before their parents
+    QVector<TorrentContentModelFolder *> parentFolders(const QVector<TorrentContentModelItem *> &items)
+    {
+        QHash<TorrentContentModelFolder *, int> folderDepths;
+        for (const TorrentContentModelItem *item : items)
+        {
+            for (TorrentContentModelFolder *folder = item->parent();
+                 folder && !folderDepths.contains(folder); folder = folder->parent())
+            {
+                int depth = 0;
+                for (const TorrentContentModelFolder *parent = folder->parent(); parent; parent = parent->parent())
+                    ++depth;
+                folderDepths.insert(folder, depth);
+            }
+        }
+
+        QVector<TorrentContentModelFolder *> folders {folderDepths.keyBegin(), folderDepths.keyEnd()};
+        std::sort(folders.begin(), folders.end(), [&folderDepths](TorrentContentModelFolder *left, TorrentContentModelFolder *right)
+        {
+            return (folderDepths.value(left) > folderDepths.value(right));
+        });
+        return folders;
+    }
 }
 
 TorrentContentModel::TorrentContentModel(QObject *parent)
@@ -214,13 +239,22 @@ void TorrentContentModel::updateFilesProgress(const QVector<qreal> &fp)
     // XXX: Why is this necessary?
     if (m_filesIndex.size() != fp.size()) return;
 
-    emit layoutAboutToBeChanged();
+    QVector<TorrentContentModelItem *> changedItems;
     for (int i = 0; i < fp.size(); ++i)
-        m_filesIndex[i]->setProgress(fp[i]);
-    // Update folders progress in the tree
-    m_rootItem->recalculateProgress();
-    m_rootItem->recalculateAvailability();
-    emit dataChanged(index(0, 0), index((rowCount() - 1), (columnCount() - 1)));
+    {
+        TorrentContentModelFile *fileItem = m_filesIndex[i];
+        if (fileItem->progress() == fp[i])
+            continue;
+
+        fileItem->setProgress(fp[i]);
+        changedItems.append(fileItem);
+    }
+
+    if (changedItems.isEmpty())
+        return;
+
+    setParentFoldersOutdated(changedItems);
+    notifyItemsChanged(changedItems, TorrentContentModelItem::COL_PROGRESS, TorrentContentModelItem::COL_REMAINING);
 }
 
 void TorrentContentModel::updateFilesPriorities(const QVector<BitTorrent::DownloadPriority> &fprio)
@@ -230,10 +264,34 @@ void TorrentContentModel::updateFilesPriorities(const QVector<BitTorrent::Downlo
     if (m_filesIndex.size() != fprio.size())
         return;
 
-    emit layoutAboutToBeChanged();
+    QVector<TorrentContentModelItem *> changedItems;
     for (int i = 0; i < fprio.size(); ++i)
-        m_filesIndex[i]->setPriority(static_cast<BitTorrent::DownloadPriority>(fprio[i]));
-    emit dataChanged(index(0, 0), index((rowCount() - 1), (columnCount() - 1)));
+    {
+        TorrentContentModelFile *fileItem = m_filesIndex[i];
+        const auto priority = static_cast<BitTorrent::DownloadPriority>(fprio[i]);
+        if (fileItem->priority() == priority)
+            continue;
+
+        // parents are updated once below
+        fileItem->setPriority(priority, false);
+        changedItems.append(fileItem);
+    }
+
+    if (changedItems.isEmpty())
+        return;
+
+    // Ignored files don't count in folder progress and availability
+    const QVector<TorrentContentModelFolder *> folders = parentFolders(changedItems);
+    for (TorrentContentModelFolder *folder : folders)
+    {
+        folder->updatePriority();
+        folder->updateProgress();
+        folder->updateAvailability();
+        if (!folder->isRootItem())
+            changedItems.append(folder);
+    }
+
+    notifyItemsChanged(changedItems, 0, (TorrentContentModelItem::NB_COL - 1));
 }
 
 void TorrentContentModel::updateFilesAvailability(const QVector<qreal> &fa)
@@ -242,12 +300,66 @@ void TorrentContentModel::updateFilesAvailability(const QVector<qreal> &fa)
     // XXX: Why is this necessary?
     if (m_filesIndex.size() != fa.size()) return;
 
-    emit layoutAboutToBeChanged();
-    for (int i = 0; i < m_filesIndex.size(); ++i)
-        m_filesIndex[i]->setAvailability(fa[i]);
-    // Update folders progress in the tree
-    m_rootItem->recalculateProgress();
-    emit dataChanged(index(0, 0), index((rowCount() - 1), (columnCount() - 1)));
+    QVector<TorrentContentModelItem *> changedItems;
+    for (int i = 0; i < fa.size(); ++i)
+    {
+        TorrentContentModelFile *fileItem = m_filesIndex[i];
+        if (fileItem->availability() == fa[i])
+            continue;
+
+        fileItem->setAvailability(fa[i]);
+        changedItems.append(fileItem);
+    }
+
+    if (changedItems.isEmpty())
+        return;
+
+    setParentFoldersOutdated(changedItems);
+    notifyItemsChanged(changedItems, TorrentContentModelItem::COL_AVAILABILITY, TorrentContentModelItem::COL_AVAILABILITY);
+}
+
+void TorrentContentModel::setParentFoldersOutdated(QVector<TorrentContentModelItem *> &changedItems)
+{
+    // Folders aren't recalculated here but only once the view requests their data.
+    // Parents of an outdated folder are outdated too, so the walk stops at the first one,
+    // and only the folders that weren't outdated yet need to be reported as changed.
+    const int changedFilesCount = changedItems.size();
+    for (int i = 0; i < changedFilesCount; ++i)
+    {
+        for (TorrentContentModelFolder *folder = changedItems[i]->parent(); (folder && !folder->isOutdated()); folder = folder->parent())
+        {
+            folder->setOutdated();
+            if (!folder->isRootItem())
+                changedItems.append(folder);
+        }
+    }
+}
+
+void TorrentContentModel::notifyItemsChanged(const QVector<TorrentContentModelItem *> &items, const int firstColumn, const int lastColumn)
+{
+    // Emit signal for each range of adjacent rows
+    QHash<TorrentContentModelFolder *, QVector<int>> rowsByParent;
+    for (const TorrentContentModelItem *item : items)
+        rowsByParent[item->parent()].append(item->row());
+
+    for (auto iter = rowsByParent.begin(); iter != rowsByParent.end(); ++iter)
+    {
+        TorrentContentModelFolder *parentItem = iter.key();
+        QVector<int> &rows = iter.value();
+        std::sort(rows.begin(), rows.end());
+
+        const QModelIndex parentIndex = parentItem->isRootItem()
+            ? QModelIndex()
+            : createIndex(parentItem->row(), 0, parentItem);
+        for (int i = 0; i < rows.size(); ++i)
+        {
+            const int firstRow = rows[i];
+            while (((i + 1) < rows.size()) && (rows[i + 1] == (rows[i] + 1)))
+                ++i;
+
+            emit dataChanged(index(firstRow, firstColumn, parentIndex), index(rows[i], lastColumn, parentIndex));
+        }
+    }
 }
 
 QVector<BitTorrent::DownloadPriority> TorrentContentModel::getFilePriorities() const
@@ -346,6 +458,8 @@ QVariant TorrentContentModel::data(const QModelIndex &index, const int role) con
         return {};
 
     auto *item = static_cast<TorrentContentModelItem*>(index.internalPointer());
+    if (item->itemType() == TorrentContentModelItem::FolderType)
+        static_cast<TorrentContentModelFolder *>(item)->updateIfOutdated();
 
     switch (role)
     {
@@ -497,31 +611,55 @@ void TorrentContentModel::setupModelData(const BitTorrent::AbstractFileStorage &
     qDebug("Torrent contains %d files", filesCount);
     m_filesIndex.reserve(filesCount);
 
-    TorrentContentModelFolder *currentParent;
-    // Iterate over files
-    for (int i = 0; i < filesCount; ++i)
+    // Folders by their paths, so the huge folders don't need to be scanned for the child folders
+    QHash<QString, TorrentContentModelFolder *> folders;
+    const auto findFolder = [this, &folders](const QString &folderPath) -> TorrentContentModelFolder *
     {
-        currentParent = m_rootItem;
-        const QString path = Utils::Fs::toUniformPath(info.filePath(i));
-
-        // Iterate of parts of the path to create necessary folders
-        QList<QStringView> pathFolders = QStringView(path).split(u'/', Qt::SkipEmptyParts);
-        pathFolders.removeLast();
+        TorrentContentModelFolder *parentFolder = m_rootItem;
 
-        for (const QStringView pathPart : asConst(pathFolders))
+        // Iterate over parts of the path to create necessary folders
+        int partStart = 0;
+        while (partStart < folderPath.size())
         {
-            const QString folderPath = pathPart.toString();
-            TorrentContentModelFolder *newParent = currentParent->childFolderWithName(folderPath);
-            if (!newParent)
+            int partEnd = folderPath.indexOf(u'/', partStart);
+            if (partEnd < 0)
+                partEnd = folderPath.size();
+
+            if (partEnd > partStart)
             {
-                newParent = new TorrentContentModelFolder(folderPath, currentParent);
-                currentParent->appendChild(newParent);
+                TorrentContentModelFolder *&folder = folders[folderPath.left(partEnd)];
+                if (!folder)
+                {
+                    folder = new TorrentContentModelFolder(folderPath.mid(partStart, (partEnd - partStart)), parentFolder);
+                    parentFolder->appendChild(folder);
+                }
+                parentFolder = folder;
             }
-            currentParent = newParent;
+
+            partStart = partEnd + 1;
         }
+
+        return parentFolder;
+    };
+
+    // Files of the same folder usually go in a row
+    QString currentFolderPath;
+    TorrentContentModelFolder *currentParent = m_rootItem;
+    // Iterate over files
+    for (int i = 0; i < filesCount; ++i)
+    {
+        const QString path = Utils::Fs::toUniformPath(info.filePath(i));
+        const int nameStart = path.lastIndexOf(u'/') + 1;
+        const QStringView folderPath = QStringView(path).left(std::max(0, (nameStart - 1)));
+        if (folderPath != currentFolderPath)
+        {
+            currentFolderPath = folderPath.toString();
+            currentParent = findFolder(currentFolderPath);
+        }
+
         // Actually create the file
         TorrentContentModelFile *fileItem = new TorrentContentModelFile(
-                    Utils::Fs::fileName(info.filePath(i)), info.fileSize(i), currentParent, i);
+                    path.mid(nameStart), info.fileSize(i), currentParent, i);
         currentParent->appendChild(fileItem);
         m_filesIndex.push_back(fileItem);
     }
@@ -84,6 +84,9 @@ public slots:
     void selectNone();
 
 private:
+    void setParentFoldersOutdated(QVector<TorrentContentModelItem *> &changedItems);
+    void notifyItemsChanged(const QVector<TorrentContentModelItem *> &items, int firstColumn, int lastColumn);
+
     TorrentContentModelFolder *m_rootItem;
     QVector<TorrentContentModelFile *> m_filesIndex;
     QFileIconProvider *m_fileIconProvider;
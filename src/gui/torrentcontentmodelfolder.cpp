@@ -75,6 +75,7 @@ const QVector<TorrentContentModelItem *> &TorrentContentModelFolder::children()
 void TorrentContentModelFolder::appendChild(TorrentContentModelItem *item)
 {
     Q_ASSERT(item);
+    item->m_row = m_childItems.size();
     m_childItems.append(item);
     // Update own size
     if (item->itemType() == FileType)
@@ -86,16 +87,6 @@ TorrentContentModelItem *TorrentContentModelFolder::child(int row) const
     return m_childItems.value(row, nullptr);
 }
 
-TorrentContentModelFolder *TorrentContentModelFolder::childFolderWithName(const QString &name) const
-{
-    for (TorrentContentModelItem *child : asConst(m_childItems))
-    {
-        if ((child->itemType() == FolderType) && (child->name() == name))
-            return static_cast<TorrentContentModelFolder *>(child);
-    }
-    return nullptr;
-}
-
 int TorrentContentModelFolder::childCount() const
 {
     return m_childItems.count();
@@ -147,6 +138,20 @@ void TorrentContentModelFolder::setPriority(BitTorrent::DownloadPriority newPrio
 
 void TorrentContentModelFolder::recalculateProgress()
 {
+    for (TorrentContentModelItem *child : asConst(m_childItems))
+    {
+        if ((child->priority() != BitTorrent::DownloadPriority::Ignored) && (child->itemType() == FolderType))
+            static_cast<TorrentContentModelFolder *>(child)->recalculateProgress();
+    }
+
+    updateProgress();
+}
+
+void TorrentContentModelFolder::updateProgress()
+{
+    if (isRootItem())
+        return;
+
     qreal tProgress = 0;
     qulonglong tSize = 0;
     qulonglong tRemaining = 0;
@@ -155,14 +160,12 @@ void TorrentContentModelFolder::recalculateProgress()
         if (child->priority() == BitTorrent::DownloadPriority::Ignored)
             continue;
 
-        if (child->itemType() == FolderType)
-            static_cast<TorrentContentModelFolder *>(child)->recalculateProgress();
         tProgress += child->progress() * child->size();
         tSize += child->size();
         tRemaining += child->remaining();
     }
 
-    if (!isRootItem() && (tSize > 0))
+    if (tSize > 0)
     {
         m_progress = tProgress / tSize;
         m_remaining = tRemaining;
@@ -172,6 +175,21 @@ void TorrentContentModelFolder::recalculateProgress()
 
 void TorrentContentModelFolder::recalculateAvailability()
 {
+    for (TorrentContentModelItem *child : asConst(m_childItems))
+    {
+        if ((child->priority() != BitTorrent::DownloadPriority::Ignored) && (child->itemType() == FolderType))
+            static_cast<TorrentContentModelFolder *>(child)->recalculateAvailability();
+    }
+
+    updateAvailability();
+}
+
+void TorrentContentModelFolder::updateAvailability()
+{
+    // root item has no availability
+    if (isRootItem())
+        return;
+
     qreal tAvailability = 0;
     qulonglong tSize = 0;
     bool foundAnyData = false;
@@ -180,8 +198,6 @@ void TorrentContentModelFolder::recalculateAvailability()
         if (child->priority() == BitTorrent::DownloadPriority::Ignored)
             continue;
 
-        if (child->itemType() == FolderType)
-            static_cast<TorrentContentModelFolder*>(child)->recalculateAvailability();
         const qreal childAvailability = child->availability();
         if (childAvailability >= 0)
         { // -1 means "no data"
@@ -191,7 +207,7 @@ void TorrentContentModelFolder::recalculateAvailability()
         tSize += child->size();
     }
 
-    if (!isRootItem() && (tSize > 0) && foundAnyData)
+    if ((tSize > 0) && foundAnyData)
     {
         m_availability = tAvailability / tSize;
         Q_ASSERT(m_availability <= 1.);
@@ -202,6 +218,34 @@ void TorrentContentModelFolder::recalculateAvailability()
     }
 }
 
+bool TorrentContentModelFolder::isOutdated() const
+{
+    return m_isOutdated;
+}
+
+void TorrentContentModelFolder::setOutdated()
+{
+    m_isOutdated = true;
+}
+
+void TorrentContentModelFolder::updateIfOutdated()
+{
+    if (!m_isOutdated)
+        return;
+
+    // Ignored subfolders are updated as well so that they don't stay outdated
+    // while their parents are not, which would break the lookup of outdated parents
+    for (TorrentContentModelItem *child : asConst(m_childItems))
+    {
+        if (child->itemType() == FolderType)
+            static_cast<TorrentContentModelFolder *>(child)->updateIfOutdated();
+    }
+
+    updateProgress();
+    updateAvailability();
+    m_isOutdated = false;
+}
+
 void TorrentContentModelFolder::increaseSize(qulonglong delta)
 {
     if (isRootItem())
@@ -51,17 +51,26 @@ public:
     void increaseSize(qulonglong delta);
     void recalculateProgress();
     void recalculateAvailability();
+    // Unlike the above ones, these don't go down the tree and expect the children to be up to date
+    void updateProgress();
+    void updateAvailability();
     void updatePriority();
 
+    // Progress and availability of outdated folders are recalculated
+    // only when they are requested, e.g. when the folder gets visible
+    bool isOutdated() const;
+    void setOutdated();
+    void updateIfOutdated();
+
     void setPriority(BitTorrent::DownloadPriority newPriority, bool updateParent = true) override;
 
     void deleteAllChildren();
     const QVector<TorrentContentModelItem*> &children() const;
     void appendChild(TorrentContentModelItem *item);
     TorrentContentModelItem *child(int row) const;
-    TorrentContentModelFolder *childFolderWithName(const QString &name) const;
     int childCount() const;
 
 private:
     QVector<TorrentContentModelItem*> m_childItems;
+    bool m_isOutdated = false;
 };
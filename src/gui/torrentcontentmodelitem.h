@@ -40,6 +40,7 @@ class TorrentContentModelFolder;
 class TorrentContentModelItem
 {
     Q_DECLARE_TR_FUNCTIONS(TorrentContentModelItem)
+    friend class TorrentContentModelFolder;
 
 public:
     enum TreeItemColumns
@@ -85,6 +86,8 @@ public:
 
 protected:
     TorrentContentModelFolder *m_parentItem;
+    // Position in the parent, children are only appended so it doesn't change
+    int m_row = 0;
     // Root item members
     QVector<QString> m_itemData;
     // Non-root item members
@@ -28,6 +28,8 @@
 
 #include "transferlistfilterswidget.h"
 
+#include <algorithm>
+
 #include <QCheckBox>
 #include <QIcon>
 #include <QListWidgetItem>
@@ -172,8 +174,13 @@ StatusFilterWidget::StatusFilterWidget(QWidget *parent, TransferListWidget *tran
     connect(BitTorrent::Session::instance(), &BitTorrent::Session::torrentLoaded
             , this, &StatusFilterWidget::updateTorrentNumbers);
     connect(BitTorrent::Session::instance(), &BitTorrent::Session::torrentsUpdated
-            , this, &StatusFilterWidget::updateTorrentNumbers);
+            , this, &StatusFilterWidget::handleTorrentsUpdated);
+    // torrent is still counted by the session when it's about to be removed
     connect(BitTorrent::Session::instance(), &BitTorrent::Session::torrentAboutToBeRemoved
+            , this, &StatusFilterWidget::updateTorrentNumbers, Qt::QueuedConnection);
+    connect(BitTorrent::Session::instance(), &BitTorrent::Session::torrentPaused
+            , this, &StatusFilterWidget::updateTorrentNumbers);
+    connect(BitTorrent::Session::instance(), &BitTorrent::Session::torrentResumed
             , this, &StatusFilterWidget::updateTorrentNumbers);
 
     // Add status filters
@@ -227,63 +234,40 @@ StatusFilterWidget::~StatusFilterWidget()
     Preferences::instance()->setTransSelFilter(currentRow());
 }
 
-void StatusFilterWidget::updateTorrentNumbers()
+void StatusFilterWidget::handleTorrentsUpdated(const QVector<BitTorrent::Torrent *> &torrents
+                                               , const QVector<BitTorrent::TorrentChangedFields> &changedFields)
 {
-    int nbDownloading = 0;
-    int nbSeeding = 0;
-    int nbCompleted = 0;
-    int nbResumed = 0;
-    int nbPaused = 0;
-    int nbActive = 0;
-    int nbInactive = 0;
-    int nbStalled = 0;
-    int nbStalledUploading = 0;
-    int nbStalledDownloading = 0;
-    int nbChecking = 0;
-    int nbErrored = 0;
-
-    const QVector<BitTorrent::Torrent *> torrents = BitTorrent::Session::instance()->torrents();
-    for (const BitTorrent::Torrent *torrent : torrents)
+    Q_UNUSED(torrents);
+
+    const bool needUpdate = std::any_of(changedFields.cbegin(), changedFields.cend()
+        , [](const BitTorrent::TorrentChangedFields fields)
     {
-        if (torrent->isDownloading())
-            ++nbDownloading;
-        if (torrent->isUploading())
-            ++nbSeeding;
-        if (torrent->isCompleted())
-            ++nbCompleted;
-        if (torrent->isResumed())
-            ++nbResumed;
-        if (torrent->isPaused())
-            ++nbPaused;
-        if (torrent->isActive())
-            ++nbActive;
-        if (torrent->isInactive())
-            ++nbInactive;
-        if (torrent->state() ==  BitTorrent::TorrentState::StalledUploading)
-            ++nbStalledUploading;
-        if (torrent->state() ==  BitTorrent::TorrentState::StalledDownloading)
-            ++nbStalledDownloading;
-        if (torrent->isChecking())
-            ++nbChecking;
-        if (torrent->isErrored())
-            ++nbErrored;
-    }
+        return fields.testFlag(BitTorrent::TorrentChangedField::StatusGroup);
+    });
+
+    if (needUpdate)
+        updateTorrentNumbers();
+}
 
-    nbStalled = nbStalledUploading + nbStalledDownloading;
-
-    item(TorrentFilter::All)->setData(Qt::DisplayRole, tr("All (%1)").arg(torrents.count()));
-    item(TorrentFilter::Downloading)->setData(Qt::DisplayRole, tr("Downloading (%1)").arg(nbDownloading));
-    item(TorrentFilter::Seeding)->setData(Qt::DisplayRole, tr("Seeding (%1)").arg(nbSeeding));
-    item(TorrentFilter::Completed)->setData(Qt::DisplayRole, tr("Completed (%1)").arg(nbCompleted));
-    item(TorrentFilter::Resumed)->setData(Qt::DisplayRole, tr("Resumed (%1)").arg(nbResumed));
-    item(TorrentFilter::Paused)->setData(Qt::DisplayRole, tr("Paused (%1)").arg(nbPaused));
-    item(TorrentFilter::Active)->setData(Qt::DisplayRole, tr("Active (%1)").arg(nbActive));
-    item(TorrentFilter::Inactive)->setData(Qt::DisplayRole, tr("Inactive (%1)").arg(nbInactive));
-    item(TorrentFilter::Stalled)->setData(Qt::DisplayRole, tr("Stalled (%1)").arg(nbStalled));
-    item(TorrentFilter::StalledUploading)->setData(Qt::DisplayRole, tr("Stalled Uploading (%1)").arg(nbStalledUploading));
-    item(TorrentFilter::StalledDownloading)->setData(Qt::DisplayRole, tr("Stalled Downloading (%1)").arg(nbStalledDownloading));
-    item(TorrentFilter::Checking)->setData(Qt::DisplayRole, tr("Checking (%1)").arg(nbChecking));
-    item(TorrentFilter::Errored)->setData(Qt::DisplayRole, tr("Errored (%1)").arg(nbErrored));
+void StatusFilterWidget::updateTorrentNumbers()
+{
+    // Torrents are counted by the session as they change their status
+    using BitTorrent::TorrentStatusGroup;
+    const BitTorrent::Session *session = BitTorrent::Session::instance();
+
+    item(TorrentFilter::All)->setData(Qt::DisplayRole, tr("All (%1)").arg(session->torrentsCount()));
+    item(TorrentFilter::Downloading)->setData(Qt::DisplayRole, tr("Downloading (%1)").arg(session->torrentsCount(TorrentStatusGroup::Downloading)));
+    item(TorrentFilter::Seeding)->setData(Qt::DisplayRole, tr("Seeding (%1)").arg(session->torrentsCount(TorrentStatusGroup::Seeding)));
+    item(TorrentFilter::Completed)->setData(Qt::DisplayRole, tr("Completed (%1)").arg(session->torrentsCount(TorrentStatusGroup::Completed)));
+    item(TorrentFilter::Resumed)->setData(Qt::DisplayRole, tr("Resumed (%1)").arg(session->torrentsCount(TorrentStatusGroup::Resumed)));
+    item(TorrentFilter::Paused)->setData(Qt::DisplayRole, tr("Paused (%1)").arg(session->torrentsCount(TorrentStatusGroup::Paused)));
+    item(TorrentFilter::Active)->setData(Qt::DisplayRole, tr("Active (%1)").arg(session->torrentsCount(TorrentStatusGroup::Active)));
+    item(TorrentFilter::Inactive)->setData(Qt::DisplayRole, tr("Inactive (%1)").arg(session->torrentsCount(TorrentStatusGroup::Inactive)));
+    item(TorrentFilter::Stalled)->setData(Qt::DisplayRole, tr("Stalled (%1)").arg(session->torrentsCount(TorrentStatusGroup::Stalled)));
+    item(TorrentFilter::StalledUploading)->setData(Qt::DisplayRole, tr("Stalled Uploading (%1)").arg(session->torrentsCount(TorrentStatusGroup::StalledUploading)));
+    item(TorrentFilter::StalledDownloading)->setData(Qt::DisplayRole, tr("Stalled Downloading (%1)").arg(session->torrentsCount(TorrentStatusGroup::StalledDownloading)));
+    item(TorrentFilter::Checking)->setData(Qt::DisplayRole, tr("Checking (%1)").arg(session->torrentsCount(TorrentStatusGroup::Checking)));
+    item(TorrentFilter::Errored)->setData(Qt::DisplayRole, tr("Errored (%1)").arg(session->torrentsCount(TorrentStatusGroup::Errored)));
 }
 
 void StatusFilterWidget::showMenu(const QPoint &) {}
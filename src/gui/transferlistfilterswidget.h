@@ -33,6 +33,7 @@
 #include <QtContainerFwd>
 
 #include "base/bittorrent/infohash.h"
+#include "base/bittorrent/torrent.h"
 #include "base/bittorrent/trackerentry.h"
 
 class QCheckBox;
@@ -40,11 +41,6 @@ class QResizeEvent;
 
 class TransferListWidget;
 
-namespace BitTorrent
-{
-    class Torrent;
-}
-
 namespace Net
 {
     struct DownloadResult;
@@ -85,6 +81,8 @@ public:
 
 private slots:
     void updateTorrentNumbers();
+    void handleTorrentsUpdated(const QVector<BitTorrent::Torrent *> &torrents
+                               , const QVector<BitTorrent::TorrentChangedFields> &changedFields);
 
 private:
     // These 4 methods are virtual slots in the base class.
@@ -29,6 +29,8 @@
 
 #include "transferlistmodel.h"
 
+#include <algorithm>
+
 #include <QApplication>
 #include <QDateTime>
 #include <QDebug>
@@ -101,6 +103,68 @@ namespace
         }
         return colors;
     }
+
+    // Bit per column
+    using ColumnMask = quint32;
+    static_assert(TransferListModel::NB_COLUMNS < (sizeof(ColumnMask) * 8));
+
+    constexpr ColumnMask columnBit(const int column)
+    {
+        return (ColumnMask(1) << column);
+    }
+
+    // Columns which need to be repainted when the given torrent fields change
+    ColumnMask changedColumns(const BitTorrent::TorrentChangedFields fields)
+    {
+        using Field = BitTorrent::TorrentChangedField;
+
+        // state affects row colors and icon
+        if (fields.testFlag(Field::State))
+            return (columnBit(TransferListModel::NB_COLUMNS) - 1);
+
+        ColumnMask columns = 0;
+        if (fields.testFlag(Field::Progress))
+        {
+            columns |= columnBit(TransferListModel::TR_SIZE) | columnBit(TransferListModel::TR_TOTAL_SIZE)
+                | columnBit(TransferListModel::TR_PROGRESS) | columnBit(TransferListModel::TR_ETA)
+                | columnBit(TransferListModel::TR_RATIO) | columnBit(TransferListModel::TR_AMOUNT_LEFT)
+                | columnBit(TransferListModel::TR_COMPLETED);
+        }
+        if (fields.testFlag(Field::Speed))
+        {
+            columns |= columnBit(TransferListModel::TR_DLSPEED) | columnBit(TransferListModel::TR_UPSPEED)
+                | columnBit(TransferListModel::TR_ETA);
+        }
+        if (fields.testFlag(Field::Peers))
+            columns |= columnBit(TransferListModel::TR_SEEDS) | columnBit(TransferListModel::TR_PEERS);
+        if (fields.testFlag(Field::TransferredAmount))
+        {
+            columns |= columnBit(TransferListModel::TR_AMOUNT_DOWNLOADED) | columnBit(TransferListModel::TR_AMOUNT_UPLOADED)
+                | columnBit(TransferListModel::TR_AMOUNT_DOWNLOADED_SESSION) | columnBit(TransferListModel::TR_AMOUNT_UPLOADED_SESSION)
+                | columnBit(TransferListModel::TR_RATIO);
+        }
+        if (fields.testFlag(Field::Tracker))
+            columns |= columnBit(TransferListModel::TR_TRACKER);
+        if (fields.testFlag(Field::Time))
+        {
+            columns |= columnBit(TransferListModel::TR_ADD_DATE) | columnBit(TransferListModel::TR_SEED_DATE)
+                | columnBit(TransferListModel::TR_TIME_ELAPSED) | columnBit(TransferListModel::TR_SEEN_COMPLETE_DATE)
+                | columnBit(TransferListModel::TR_LAST_ACTIVITY);
+        }
+        if (fields.testFlag(Field::Availability))
+            columns |= columnBit(TransferListModel::TR_AVAILABILITY);
+        if (fields.testFlag(Field::SavePath))
+            columns |= columnBit(TransferListModel::TR_SAVE_PATH);
+        if (fields.testFlag(Field::QueuePosition))
+            columns |= columnBit(TransferListModel::TR_QUEUE_POSITION);
+        if (fields.testFlag(Field::Name))
+            columns |= columnBit(TransferListModel::TR_NAME);
+        // let the sort model know that the row should be filtered again
+        if (fields.testFlag(Field::StatusGroup))
+            columns |= columnBit(TransferListModel::TR_STATUS);
+
+        return columns;
+    }
 }
 
 // TransferListModel
@@ -148,6 +212,13 @@ TransferListModel::TransferListModel(QObject *parent)
     connect(Session::instance(), &Session::torrentResumed, this, &TransferListModel::handleTorrentStatusUpdated);
     connect(Session::instance(), &Session::torrentPaused, this, &TransferListModel::handleTorrentStatusUpdated);
     connect(Session::instance(), &Session::torrentFinishedChecking, this, &TransferListModel::handleTorrentStatusUpdated);
+    // properties that aren't covered by status updates
+    connect(Session::instance(), &Session::torrentPropertiesChanged, this, &TransferListModel::handleTorrentStatusUpdated);
+    connect(Session::instance(), &Session::torrentCategoryChanged, this, &TransferListModel::handleTorrentStatusUpdated);
+    connect(Session::instance(), &Session::torrentTagAdded, this, &TransferListModel::handleTorrentStatusUpdated);
+    connect(Session::instance(), &Session::torrentTagRemoved, this, &TransferListModel::handleTorrentStatusUpdated);
+    connect(Session::instance(), &Session::torrentSavePathChanged, this, &TransferListModel::handleTorrentStatusUpdated);
+    connect(Session::instance(), &Session::trackersChanged, this, &TransferListModel::handleTorrentStatusUpdated);
 }
 
 int TransferListModel::rowCount(const QModelIndex &) const
@@ -616,24 +687,67 @@ void TransferListModel::handleTorrentStatusUpdated(BitTorrent::Torrent *const to
     emit dataChanged(index(row, 0), index(row, columnCount() - 1));
 }
 
-void TransferListModel::handleTorrentsUpdated(const QVector<BitTorrent::Torrent *> &torrents)
+void TransferListModel::handleTorrentsUpdated(const QVector<BitTorrent::Torrent *> &torrents
+    , const QVector<BitTorrent::TorrentChangedFields> &changedFields)
 {
-    const int columns = (columnCount() - 1);
+    Q_ASSERT(torrents.size() == changedFields.size());
+
+    // Emits signal for each range of adjacent columns so that the views repaint only the changed cells
+    // and the sort model re-sorts rows only if the sort column is affected
+    const auto emitDataChanged = [this](const int firstRow, const int lastRow, const ColumnMask columns)
+    {
+        for (int column = 0; column < NB_COLUMNS; ++column)
+        {
+            if (!(columns & columnBit(column)))
+                continue;
+
+            const int firstColumn = column;
+            while (((column + 1) < NB_COLUMNS) && (columns & columnBit(column + 1)))
+                ++column;
+
+            emit dataChanged(index(firstRow, firstColumn), index(lastRow, column));
+        }
+    };
 
     if (torrents.size() <= (m_torrentList.size() * 0.5))
     {
-        for (BitTorrent::Torrent *const torrent : torrents)
+        QVector<QPair<int, ColumnMask>> changedRows;
+        changedRows.reserve(torrents.size());
+        for (int i = 0; i < torrents.size(); ++i)
         {
-            const int row = m_torrentMap.value(torrent, -1);
+            const int row = m_torrentMap.value(torrents[i], -1);
             Q_ASSERT(row >= 0);
 
-            emit dataChanged(index(row, 0), index(row, columns));
+            const ColumnMask columns = changedColumns(changedFields[i]);
+            if (columns != 0)
+                changedRows.append({row, columns});
+        }
+
+        std::sort(changedRows.begin(), changedRows.end());
+
+        // merge adjacent rows with the same changed columns
+        for (int i = 0; i < changedRows.size(); ++i)
+        {
+            const auto [firstRow, columns] = changedRows[i];
+            int lastRow = firstRow;
+            while (((i + 1) < changedRows.size()) && (changedRows[i + 1].first == (lastRow + 1))
+                   && (changedRows[i + 1].second == columns))
+            {
+                ++i;
+                ++lastRow;
+            }
+
+            emitDataChanged(firstRow, lastRow, columns);
         }
     }
     else
     {
         // save the overhead when more than half of the torrent list needs update
-        emit dataChanged(index(0, 0), index((rowCount() - 1), columns));
+        ColumnMask columns = 0;
+        for (const BitTorrent::TorrentChangedFields fields : changedFields)
+            columns |= changedColumns(fields);
+
+        emitDataChanged(0, (rowCount() - 1), columns);
     }
 }
 
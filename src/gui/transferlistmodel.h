@@ -105,7 +105,8 @@ private slots:
     void addTorrent(BitTorrent::Torrent *const torrent);
     void handleTorrentAboutToBeRemoved(BitTorrent::Torrent *const torrent);
     void handleTorrentStatusUpdated(BitTorrent::Torrent *const torrent);
-    void handleTorrentsUpdated(const QVector<BitTorrent::Torrent *> &torrents);
+    void handleTorrentsUpdated(const QVector<BitTorrent::Torrent *> &torrents
+                               , const QVector<BitTorrent::TorrentChangedFields> &changedFields);
 
 private:
     void configure();
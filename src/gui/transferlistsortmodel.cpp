@@ -28,13 +28,11 @@
 
 #include "transferlistsortmodel.h"
 
+#include <algorithm>
 #include <type_traits>
 
-#include <QDateTime>
-
 #include "base/bittorrent/infohash.h"
 #include "base/bittorrent/torrent.h"
-#include "transferlistmodel.h"
 
 namespace
 {
@@ -56,13 +54,16 @@ namespace
         return isLeftValid ? -1 : 1;
     }
 
-    int customCompare(const TagSet &left, const TagSet &right, const Utils::Compare::NaturalCompare<Qt::CaseInsensitive> &compare)
+    template <typename SortKey>
+    int customCompare(const std::vector<SortKey> &left, const std::vector<SortKey> &right)
     {
+        using NaturalCompare = Utils::Compare::NaturalCompare<Qt::CaseInsensitive>;
+
         for (auto leftIter = left.cbegin(), rightIter = right.cbegin();
             (leftIter != left.cend()) && (rightIter != right.cend());
             ++leftIter, ++rightIter)
         {
-            const int result = compare(*leftIter, *rightIter);
+            const int result = NaturalCompare::compare(*leftIter, *rightIter);
             if (result != 0)
                 return result;
         }
@@ -99,6 +100,34 @@ TransferListSortModel::TransferListSortModel(QObject *parent)
     setSortRole(TransferListModel::UnderlyingDataRole);
 }
 
+void TransferListSortModel::setSourceModel(QAbstractItemModel *sourceModel)
+{
+    if (QAbstractItemModel *oldModel = this->sourceModel())
+    {
+        disconnect(oldModel, &QAbstractItemModel::dataChanged, this, &TransferListSortModel::handleSourceDataChanged);
+        disconnect(oldModel, &QAbstractItemModel::rowsInserted, this, &TransferListSortModel::handleSourceRowsInserted);
+        disconnect(oldModel, &QAbstractItemModel::rowsRemoved, this, &TransferListSortModel::handleSourceRowsRemoved);
+        disconnect(oldModel, &QAbstractItemModel::rowsMoved, this, &TransferListSortModel::clearCache);
+        disconnect(oldModel, &QAbstractItemModel::layoutChanged, this, &TransferListSortModel::clearCache);
+        disconnect(oldModel, &QAbstractItemModel::modelReset, this, &TransferListSortModel::clearCache);
+    }
+
+    clearCache();
+
+    // Sort keys must be updated before the base class handles the changes so connect them first
+    if (sourceModel)
+    {
+        connect(sourceModel, &QAbstractItemModel::dataChanged, this, &TransferListSortModel::handleSourceDataChanged);
+        connect(sourceModel, &QAbstractItemModel::rowsInserted, this, &TransferListSortModel::handleSourceRowsInserted);
+        connect(sourceModel, &QAbstractItemModel::rowsRemoved, this, &TransferListSortModel::handleSourceRowsRemoved);
+        connect(sourceModel, &QAbstractItemModel::rowsMoved, this, &TransferListSortModel::clearCache);
+        connect(sourceModel, &QAbstractItemModel::layoutChanged, this, &TransferListSortModel::clearCache);
+        connect(sourceModel, &QAbstractItemModel::modelReset, this, &TransferListSortModel::clearCache);
+    }
+
+    QSortFilterProxyModel::setSourceModel(sourceModel);
+}
+
 void TransferListSortModel::sort(const int column, const Qt::SortOrder order)
 {
     if ((m_lastSortColumn != column) && (m_lastSortColumn != -1))
@@ -115,61 +144,220 @@ void TransferListSortModel::sort(const int column, const Qt::SortOrder order)
 void TransferListSortModel::setStatusFilter(TorrentFilter::Type filter)
 {
     if (m_filter.setType(filter))
+    {
+        m_filterMatches.clear();
         invalidateFilter();
+    }
 }
 
 void TransferListSortModel::setCategoryFilter(const QString &category)
 {
     if (m_filter.setCategory(category))
+    {
+        m_filterMatches.clear();
         invalidateFilter();
+    }
 }
 
 void TransferListSortModel::disableCategoryFilter()
 {
     if (m_filter.setCategory(TorrentFilter::AnyCategory))
+    {
+        m_filterMatches.clear();
         invalidateFilter();
+    }
 }
 
 void TransferListSortModel::setTagFilter(const QString &tag)
 {
     if (m_filter.setTag(tag))
+    {
+        m_filterMatches.clear();
         invalidateFilter();
+    }
 }
 
 void TransferListSortModel::disableTagFilter()
 {
     if (m_filter.setTag(TorrentFilter::AnyTag))
+    {
+        m_filterMatches.clear();
         invalidateFilter();
+    }
 }
 
 void TransferListSortModel::setTrackerFilter(const QSet<BitTorrent::TorrentID> &torrentIDs)
 {
     if (m_filter.setTorrentIDSet(torrentIDs))
+    {
+        m_filterMatches.clear();
         invalidateFilter();
+    }
 }
 
 void TransferListSortModel::disableTrackerFilter()
 {
     if (m_filter.setTorrentIDSet(TorrentFilter::AnyID))
+    {
+        m_filterMatches.clear();
         invalidateFilter();
+    }
+}
+
+void TransferListSortModel::handleSourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+{
+    // Filter depends on torrent status, category and tags
+    const auto isColumnChanged = [&topLeft, &bottomRight](const int column)
+    {
+        return ((column >= topLeft.column()) && (column <= bottomRight.column()));
+    };
+    if (isColumnChanged(TransferListModel::TR_STATUS) || isColumnChanged(TransferListModel::TR_CATEGORY)
+        || isColumnChanged(TransferListModel::TR_TAGS))
+    {
+        const int lastRow = std::min(bottomRight.row(), (static_cast<int>(m_filterMatches.size()) - 1));
+        for (int row = topLeft.row(); row <= lastRow; ++row)
+            m_filterMatches[row].reset();
+    }
+
+    for (int column = topLeft.column(); column <= bottomRight.column(); ++column)
+    {
+        std::vector<SortKey> &keys = m_sortKeys[column];
+        const int lastRow = std::min(bottomRight.row(), (static_cast<int>(keys.size()) - 1));
+        for (int row = topLeft.row(); row <= lastRow; ++row)
+            keys[row] = std::monostate();
+    }
+}
+
+void TransferListSortModel::handleSourceRowsInserted(const QModelIndex &, const int first, const int last)
+{
+    for (std::vector<SortKey> &keys : m_sortKeys)
+    {
+        if (static_cast<int>(keys.size()) >= first)
+            keys.insert((keys.begin() + first), (last - first + 1), SortKey());
+    }
+
+    if (static_cast<int>(m_filterMatches.size()) >= first)
+        m_filterMatches.insert((m_filterMatches.begin() + first), (last - first + 1), std::nullopt);
+}
+
+void TransferListSortModel::handleSourceRowsRemoved(const QModelIndex &, const int first, const int last)
+{
+    for (std::vector<SortKey> &keys : m_sortKeys)
+    {
+        if (static_cast<int>(keys.size()) > first)
+            keys.erase((keys.begin() + first), (keys.begin() + std::min((last + 1), static_cast<int>(keys.size()))));
+    }
+
+    if (static_cast<int>(m_filterMatches.size()) > first)
+    {
+        m_filterMatches.erase((m_filterMatches.begin() + first)
+            , (m_filterMatches.begin() + std::min((last + 1), static_cast<int>(m_filterMatches.size()))));
+    }
+}
+
+void TransferListSortModel::clearCache()
+{
+    for (std::vector<SortKey> &keys : m_sortKeys)
+        keys = {};
+    m_filterMatches = {};
+}
+
+const TransferListSortModel::SortKey &TransferListSortModel::sortKey(const int sourceRow, const int column) const
+{
+    SortKey &key = m_sortKeys[column][sourceRow];
+    if (std::holds_alternative<std::monostate>(key))
+        key = makeSortKey(sourceRow, column);
+    return key;
+}
+
+TransferListSortModel::SortKey TransferListSortModel::makeSortKey(const int sourceRow, const int column) const
+{
+    const QModelIndex index = sourceModel()->index(sourceRow, column);
+    const QVariant value = index.data(TransferListModel::UnderlyingDataRole);
+
+    switch (column)
+    {
+    case TransferListModel::TR_CATEGORY:
+    case TransferListModel::TR_NAME:
+    case TransferListModel::TR_SAVE_PATH:
+    case TransferListModel::TR_TRACKER:
+        return m_naturalCompare.sortKey(value.toString());
+
+    case TransferListModel::TR_TAGS:
+        {
+            const TagSet tags = value.value<TagSet>();
+            std::vector<NaturalCompare::SortKey> keys;
+            keys.reserve(tags.size());
+            for (const QString &tag : tags)
+                keys.push_back(m_naturalCompare.sortKey(tag));
+            return keys;
+        }
+
+    case TransferListModel::TR_AMOUNT_DOWNLOADED:
+    case TransferListModel::TR_AMOUNT_DOWNLOADED_SESSION:
+    case TransferListModel::TR_AMOUNT_LEFT:
+    case TransferListModel::TR_AMOUNT_UPLOADED:
+    case TransferListModel::TR_AMOUNT_UPLOADED_SESSION:
+    case TransferListModel::TR_COMPLETED:
+    case TransferListModel::TR_ETA:
+    case TransferListModel::TR_LAST_ACTIVITY:
+    case TransferListModel::TR_SIZE:
+    case TransferListModel::TR_TIME_ELAPSED:
+    case TransferListModel::TR_TOTAL_SIZE:
+        return value.toLongLong();
+
+    case TransferListModel::TR_AVAILABILITY:
+    case TransferListModel::TR_PROGRESS:
+    case TransferListModel::TR_RATIO:
+    case TransferListModel::TR_RATIO_LIMIT:
+        return value.toReal();
+
+    case TransferListModel::TR_ADD_DATE:
+    case TransferListModel::TR_SEED_DATE:
+    case TransferListModel::TR_SEEN_COMPLETE_DATE:
+        return value.toDateTime();
+
+    case TransferListModel::TR_DLLIMIT:
+    case TransferListModel::TR_DLSPEED:
+    case TransferListModel::TR_QUEUE_POSITION:
+    case TransferListModel::TR_STATUS:
+    case TransferListModel::TR_UPLIMIT:
+    case TransferListModel::TR_UPSPEED:
+        return value.toInt();
+
+    case TransferListModel::TR_PEERS:
+    case TransferListModel::TR_SEEDS:
+        // Active peers/seeds take precedence over total peers/seeds
+        return std::pair {value.toInt(), index.data(TransferListModel::AdditionalUnderlyingDataRole).toInt()};
+
+    default:
+        Q_ASSERT_X(false, Q_FUNC_INFO, "Missing comparison case");
+        break;
+    }
+
+    return {};
 }
 
-int TransferListSortModel::compare(const QModelIndex &left, const QModelIndex &right) const
+int TransferListSortModel::compare(const int leftRow, const int rightRow, const int column) const
 {
-    const int compareColumn = left.column();
-    const QVariant leftValue = left.data(TransferListModel::UnderlyingDataRole);
-    const QVariant rightValue = right.data(TransferListModel::UnderlyingDataRole);
+    std::vector<SortKey> &keys = m_sortKeys[column];
+    const int rowCount = sourceModel()->rowCount();
+    if (static_cast<int>(keys.size()) < rowCount)
+        keys.resize(rowCount);
 
-    switch (compareColumn)
+    const SortKey &leftKey = sortKey(leftRow, column);
+    const SortKey &rightKey = sortKey(rightRow, column);
+
+    switch (column)
     {
     case TransferListModel::TR_CATEGORY:
     case TransferListModel::TR_NAME:
     case TransferListModel::TR_SAVE_PATH:
     case TransferListModel::TR_TRACKER:
-        return m_naturalCompare(leftValue.toString(), rightValue.toString());
+        return NaturalCompare::compare(std::get<NaturalCompare::SortKey>(leftKey), std::get<NaturalCompare::SortKey>(rightKey));
 
     case TransferListModel::TR_TAGS:
-        return customCompare(leftValue.value<TagSet>(), rightValue.value<TagSet>(), m_naturalCompare);
+        return customCompare(std::get<std::vector<NaturalCompare::SortKey>>(leftKey), std::get<std::vector<NaturalCompare::SortKey>>(rightKey));
 
     case TransferListModel::TR_AMOUNT_DOWNLOADED:
     case TransferListModel::TR_AMOUNT_DOWNLOADED_SESSION:
@@ -182,42 +370,32 @@ int TransferListSortModel::compare(const QModelIndex &left, const QModelIndex &r
     case TransferListModel::TR_SIZE:
     case TransferListModel::TR_TIME_ELAPSED:
     case TransferListModel::TR_TOTAL_SIZE:
-        return customCompare(leftValue.toLongLong(), rightValue.toLongLong());
+        return customCompare(std::get<qlonglong>(leftKey), std::get<qlonglong>(rightKey));
 
     case TransferListModel::TR_AVAILABILITY:
     case TransferListModel::TR_PROGRESS:
     case TransferListModel::TR_RATIO:
     case TransferListModel::TR_RATIO_LIMIT:
-        return customCompare(leftValue.toReal(), rightValue.toReal());
+        return customCompare(std::get<qreal>(leftKey), std::get<qreal>(rightKey));
 
     case TransferListModel::TR_STATUS:
-        return threeWayCompare(leftValue.toInt(), rightValue.toInt());
+        return threeWayCompare(std::get<int>(leftKey), std::get<int>(rightKey));
 
     case TransferListModel::TR_ADD_DATE:
     case TransferListModel::TR_SEED_DATE:
     case TransferListModel::TR_SEEN_COMPLETE_DATE:
-        return customCompare(leftValue.toDateTime(), rightValue.toDateTime());
+        return customCompare(std::get<QDateTime>(leftKey), std::get<QDateTime>(rightKey));
 
     case TransferListModel::TR_DLLIMIT:
     case TransferListModel::TR_DLSPEED:
     case TransferListModel::TR_QUEUE_POSITION:
     case TransferListModel::TR_UPLIMIT:
     case TransferListModel::TR_UPSPEED:
-        return customCompare(leftValue.toInt(), rightValue.toInt());
+        return customCompare(std::get<int>(leftKey), std::get<int>(rightKey));
 
     case TransferListModel::TR_PEERS:
     case TransferListModel::TR_SEEDS:
-        {
-            // Active peers/seeds take precedence over total peers/seeds
-            const auto activeL = leftValue.toInt();
-            const auto activeR = rightValue.toInt();
-            if (activeL != activeR)
-                return threeWayCompare(activeL, activeR);
-
-            const auto totalL = left.data(TransferListModel::AdditionalUnderlyingDataRole).toInt();
-            const auto totalR = right.data(TransferListModel::AdditionalUnderlyingDataRole).toInt();
-            return threeWayCompare(totalL, totalR);
-        }
+        return threeWayCompare(std::get<std::pair<int, int>>(leftKey), std::get<std::pair<int, int>>(rightKey));
 
     default:
         Q_ASSERT_X(false, Q_FUNC_INFO, "Missing comparison case");
@@ -231,10 +409,10 @@ bool TransferListSortModel::lessThan(const QModelIndex &left, const QModelIndex
 {
     Q_ASSERT(left.column() == right.column());
 
-    const int result = compare(left, right);
+    const int result = compare(left.row(), right.row(), left.column());
     if (result == 0)
     {
-        const int subResult = compare(left.sibling(left.row(), m_subSortColumn), right.sibling(right.row(), m_subSortColumn));
+        const int subResult = compare(left.row(), right.row(), m_subSortColumn);
         // Qt inverses lessThan() result when ordered descending.
         // For sub-sorting we have to do it manually.
         // When both are ordered descending subResult must be double-inversed, which is the same as no inversion.
@@ -256,8 +434,17 @@ bool TransferListSortModel::matchFilter(const int sourceRow, const QModelIndex &
     const auto *model = qobject_cast<TransferListModel *>(sourceModel());
     if (!model) return false;
 
-    const BitTorrent::Torrent *torrent = model->torrentHandle(model->index(sourceRow, 0, sourceParent));
-    if (!torrent) return false;
+    if (static_cast<int>(m_filterMatches.size()) <= sourceRow)
+        m_filterMatches.resize(model->rowCount());
+
+    std::optional<bool> &isMatched = m_filterMatches[sourceRow];
+    if (!isMatched)
+    {
+        const BitTorrent::Torrent *torrent = model->torrentHandle(model->index(sourceRow, 0, sourceParent));
+        if (!torrent) return false;
+
+        isMatched = m_filter.match(torrent);
+    }
 
-    return m_filter.match(torrent);
+    return *isMatched;
 }
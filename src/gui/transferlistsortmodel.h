@@ -28,11 +28,19 @@
 
 #pragma once
 
+#include <array>
+#include <optional>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include <QDateTime>
 #include <QSortFilterProxyModel>
 
 #include "base/settingvalue.h"
 #include "base/torrentfilter.h"
 #include "base/utils/compare.h"
+#include "transferlistmodel.h"
 
 namespace BitTorrent
 {
@@ -47,6 +55,7 @@ class TransferListSortModel final : public QSortFilterProxyModel
 public:
     explicit TransferListSortModel(QObject *parent = nullptr);
 
+    void setSourceModel(QAbstractItemModel *sourceModel) override;
     void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
 
     void setStatusFilter(TorrentFilter::Type filter);
@@ -58,7 +67,19 @@ public:
     void disableTrackerFilter();
 
 private:
-    int compare(const QModelIndex &left, const QModelIndex &right) const;
+    using NaturalCompare = Utils::Compare::NaturalCompare<Qt::CaseInsensitive>;
+    // Typed value of the sort column, `std::monostate` when it isn't computed yet
+    using SortKey = std::variant<std::monostate, int, qlonglong, qreal, QDateTime, NaturalCompare::SortKey
+        , std::vector<NaturalCompare::SortKey>, std::pair<int, int>>;
+
+    void handleSourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+    void handleSourceRowsInserted(const QModelIndex &parent, int first, int last);
+    void handleSourceRowsRemoved(const QModelIndex &parent, int first, int last);
+    void clearCache();
+
+    const SortKey &sortKey(int sourceRow, int column) const;
+    SortKey makeSortKey(int sourceRow, int column) const;
+    int compare(int leftRow, int rightRow, int column) const;
 
     bool lessThan(const QModelIndex &left, const QModelIndex &right) const override;
     bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
@@ -70,5 +91,9 @@ private:
     int m_lastSortColumn = -1;
     int m_lastSortOrder = 0;
 
-    Utils::Compare::NaturalCompare<Qt::CaseInsensitive> m_naturalCompare;
+    NaturalCompare m_naturalCompare;
+    // Sort keys of source rows per column, they are computed when needed and invalidated when data changes
+    mutable std::array<std::vector<SortKey>, TransferListModel::NB_COLUMNS> m_sortKeys;
+    // Results of `m_filter` per source row, they are invalidated only when the row crosses some filter boundary
+    mutable std::vector<std::optional<bool>> m_filterMatches;
 };
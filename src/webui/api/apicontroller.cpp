@@ -35,6 +35,7 @@
 #include <QMetaObject>
 #include <QVector>
 
+#include "base/http/eventsource.h"
 #include "apierror.h"
 
 APIController::APIController(ISessionManager *sessionManager, QObject *parent)
@@ -46,6 +47,7 @@ APIController::APIController(ISessionManager *sessionManager, QObject *parent)
 QVariant APIController::run(const QString &action, const StringMap &params, const DataMap &data)
 {
     m_result.clear(); // clear result
+    m_eventSource.reset();
     m_params = params;
     m_data = data;
 
@@ -56,6 +58,11 @@ QVariant APIController::run(const QString &action, const StringMap &params, cons
     return m_result;
 }
 
+std::shared_ptr<Http::EventSource> APIController::takeEventSource()
+{
+    return std::move(m_eventSource);
+}
+
 ISessionManager *APIController::sessionManager() const
 {
     return m_sessionManager;
@@ -83,6 +90,11 @@ void APIController::requireParams(const QVector<QString> &requiredParams) const
         throw APIError(APIErrorType::BadParams);
 }
 
+bool APIController::isCBORRequested() const
+{
+    return (params().value(PARAM_FORMAT) == QLatin1String(FORMAT_CBOR));
+}
+
 void APIController::setResult(const QString &result)
 {
     m_result = result;
@@ -97,3 +109,18 @@ void APIController::setResult(const QJsonObject &result)
 {
     m_result = QJsonDocument(result);
 }
+
+void APIController::setResult(const QVariantList &result)
+{
+    m_result = result;
+}
+
+void APIController::setResult(const QVariantMap &result)
+{
+    m_result = result;
+}
+
+void APIController::setEventSource(std::shared_ptr<Http::EventSource> eventSource)
+{
+    m_eventSource = std::move(eventSource);
+}
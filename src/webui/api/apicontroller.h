@@ -28,17 +28,28 @@
 
 #pragma once
 
+#include <memory>
+
 #include <QObject>
 #include <QVariant>
 #include <QtContainerFwd>
 
 class QString;
 
+namespace Http
+{
+    class EventSource;
+}
+
 struct ISessionManager;
 
 using DataMap = QHash<QString, QByteArray>;
 using StringMap = QHash<QString, QString>;
 
+// Result format requested by "format" param
+inline const char PARAM_FORMAT[] = "format";
+inline const char FORMAT_CBOR[] = "cbor";
+
 class APIController : public QObject
 {
     Q_OBJECT
@@ -53,6 +64,8 @@ public:
     explicit APIController(ISessionManager *sessionManager, QObject *parent = nullptr);
 
     QVariant run(const QString &action, const StringMap &params, const DataMap &data = {});
+    // Actions that push their data as it changes respond with event source instead of the result
+    std::shared_ptr<Http::EventSource> takeEventSource();
 
     ISessionManager *sessionManager() const;
 
@@ -60,14 +73,21 @@ protected:
     const StringMap &params() const;
     const DataMap &data() const;
     void requireParams(const QVector<QString> &requiredParams) const;
+    // Compact binary formats can use more compact data layout
+    bool isCBORRequested() const;
 
     void setResult(const QString &result);
     void setResult(const QJsonArray &result);
     void setResult(const QJsonObject &result);
+    // Large results are better set as is, they are written to the response without intermediate JSON document
+    void setResult(const QVariantList &result);
+    void setResult(const QVariantMap &result);
+    void setEventSource(std::shared_ptr<Http::EventSource> eventSource);
 
 private:
     ISessionManager *m_sessionManager;
     StringMap m_params;
     DataMap m_data;
     QVariant m_result;
+    std::shared_ptr<Http::EventSource> m_eventSource;
 };
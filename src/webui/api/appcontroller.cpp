@@ -285,6 +285,12 @@ void AppController::preferencesAction()
     data["current_interface_address"] = BitTorrent::Session::instance()->networkInterfaceAddress();
     // Save resume data interval
     data["save_resume_data_interval"] = session->saveResumeDataInterval();
+    // Save resume data timeout
+    data["save_resume_data_timeout"] = session->saveResumeDataTimeout();
+    // SQLite resume data storage
+    data["resume_data_storage_sync_level"] = session->resumeDataStorageSyncLevel();
+    data["resume_data_storage_write_batch_size"] = session->resumeDataStorageWriteBatchSize();
+    data["resume_data_storage_write_batch_delay"] = session->resumeDataStorageWriteBatchDelay();
     // Recheck completed torrents
     data["recheck_completed_torrents"] = pref->recheckTorrentsOnCompletion();
     // Resolve peer countries
@@ -745,6 +751,16 @@ void AppController::setPreferencesAction()
     // Save resume data interval
     if (hasKey("save_resume_data_interval"))
         session->setSaveResumeDataInterval(it.value().toInt());
+    // Save resume data timeout
+    if (hasKey("save_resume_data_timeout"))
+        session->setSaveResumeDataTimeout(it.value().toInt());
+    // SQLite resume data storage
+    if (hasKey("resume_data_storage_sync_level"))
+        session->setResumeDataStorageSyncLevel(it.value().toInt());
+    if (hasKey("resume_data_storage_write_batch_size"))
+        session->setResumeDataStorageWriteBatchSize(it.value().toInt());
+    if (hasKey("resume_data_storage_write_batch_delay"))
+        session->setResumeDataStorageWriteBatchDelay(it.value().toInt());
     // Recheck completed torrents
     if (hasKey("recheck_completed_torrents"))
         pref->recheckTorrentsOnCompletion(it.value().toBool());
@@ -0,0 +1,121 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2021  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "cborwriter.h"
+
+#include <QCborValue>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+
+CborWriter::CborWriter()
+    : m_device {&m_buffer}
+    , m_writer {&m_device}
+{
+    m_device.open(QIODevice::WriteOnly);
+}
+
+void CborWriter::write(const QVariant &value)
+{
+    writeValue(value);
+}
+
+QByteArray CborWriter::data() const
+{
+    return m_buffer;
+}
+
+void CborWriter::writeValue(const QVariant &value)
+{
+    switch (value.userType())
+    {
+    case QMetaType::UnknownType:
+    case QMetaType::Nullptr:
+        m_writer.appendNull();
+        break;
+    case QMetaType::Bool:
+        m_writer.append(value.toBool());
+        break;
+    case QMetaType::Int:
+    case QMetaType::Long:
+    case QMetaType::Short:
+    case QMetaType::LongLong:
+        m_writer.append(qint64 {value.toLongLong()});
+        break;
+    case QMetaType::UInt:
+    case QMetaType::ULong:
+    case QMetaType::UShort:
+    case QMetaType::ULongLong:
+        m_writer.append(quint64 {value.toULongLong()});
+        break;
+    case QMetaType::Float:
+    case QMetaType::Double:
+        m_writer.append(value.toDouble());
+        break;
+    case QMetaType::QString:
+        m_writer.append(value.toString());
+        break;
+    case QMetaType::QStringList:
+        writeArray(value.toStringList());
+        break;
+    case QMetaType::QVariantList:
+        writeArray(value.toList());
+        break;
+    case QMetaType::QVariantMap:
+        writeMap(value.toMap());
+        break;
+    case QMetaType::QVariantHash:
+        writeMap(value.toHash());
+        break;
+    default:
+        // QCborMap, QJsonObject etc.
+        QCborValue::fromVariant(value).toCbor(m_writer);
+        break;
+    }
+}
+
+template <typename Map>
+void CborWriter::writeMap(const Map &map)
+{
+    m_writer.startMap(map.size());
+    for (auto iter = map.cbegin(); iter != map.cend(); ++iter)
+    {
+        m_writer.append(iter.key());
+        writeValue(iter.value());
+    }
+    m_writer.endMap();
+}
+
+template <typename List>
+void CborWriter::writeArray(const List &list)
+{
+    m_writer.startArray(list.size());
+    for (const auto &item : list)
+        writeValue(item);
+    m_writer.endArray();
+}
@@ -0,0 +1,189 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2021  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+
+#include "jsonwriter.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLocale>
+#include <QString>
+#include <QStringList>
+#include <QtNumeric>
+#include <QVariant>
+
+void JsonWriter::write(const QVariant &value)
+{
+    writeValue(value);
+}
+
+QByteArray JsonWriter::data() const
+{
+    return m_buffer;
+}
+
+void JsonWriter::writeValue(const QVariant &value)
+{
+    // Follows the conversions of QJsonValue::fromVariant()
+    switch (value.userType())
+    {
+    case QMetaType::UnknownType:
+    case QMetaType::Nullptr:
+        m_buffer.append("null");
+        break;
+    case QMetaType::Bool:
+        m_buffer.append(value.toBool() ? "true" : "false");
+        break;
+    case QMetaType::Int:
+    case QMetaType::Long:
+    case QMetaType::Short:
+    case QMetaType::LongLong:
+        m_buffer.append(QByteArray::number(value.toLongLong()));
+        break;
+    case QMetaType::UInt:
+    case QMetaType::ULong:
+    case QMetaType::UShort:
+    case QMetaType::ULongLong:
+        m_buffer.append(QByteArray::number(value.toULongLong()));
+        break;
+    case QMetaType::Float:
+    case QMetaType::Double:
+        {
+            const double number = value.toDouble();
+            if (qIsFinite(number))
+                m_buffer.append(QByteArray::number(number, 'g', QLocale::FloatingPointShortest));
+            else
+                m_buffer.append("null");
+        }
+        break;
+    case QMetaType::QString:
+        writeString(value.toString());
+        break;
+    case QMetaType::QStringList:
+        writeArray(value.toStringList());
+        break;
+    case QMetaType::QVariantList:
+        writeArray(value.toList());
+        break;
+    case QMetaType::QVariantMap:
+        writeObject(value.toMap());
+        break;
+    case QMetaType::QVariantHash:
+        writeObject(value.toHash());
+        break;
+    case QMetaType::QJsonObject:
+        m_buffer.append(QJsonDocument(value.toJsonObject()).toJson(QJsonDocument::Compact));
+        break;
+    case QMetaType::QJsonArray:
+        m_buffer.append(QJsonDocument(value.toJsonArray()).toJson(QJsonDocument::Compact));
+        break;
+    default:
+        if (value.canConvert<QString>())
+            writeString(value.toString());
+        else
+            m_buffer.append("null");
+        break;
+    }
+}
+
+void JsonWriter::writeString(const QString &str)
+{
+    // [rfc8259] 7. Strings
+    const QByteArray utf8 = str.toUtf8();
+
+    m_buffer.append('"');
+    int unescapedBegin = 0;
+    for (int i = 0; i < utf8.size(); ++i)
+    {
+        const auto c = static_cast<uchar>(utf8[i]);
+        if ((c >= 0x20) && (c != '"') && (c != '\\'))
+            continue;
+
+        m_buffer.append(QByteArray::fromRawData((utf8.constData() + unescapedBegin), (i - unescapedBegin)));
+        unescapedBegin = i + 1;
+
+        switch (c)
+        {
+        case '"':
+            m_buffer.append("\\\"");
+            break;
+        case '\\':
+            m_buffer.append("\\\\");
+            break;
+        case '\b':
+            m_buffer.append("\\b");
+            break;
+        case '\f':
+            m_buffer.append("\\f");
+            break;
+        case '\n':
+            m_buffer.append("\\n");
+            break;
+        case '\r':
+            m_buffer.append("\\r");
+            break;
+        case '\t':
+            m_buffer.append("\\t");
+            break;
+        default:
+            m_buffer.append("\\u00");
+            m_buffer.append(QByteArray::number(c, 16).rightJustified(2, '0'));
+            break;
+        }
+    }
+    m_buffer.append(QByteArray::fromRawData((utf8.constData() + unescapedBegin), (utf8.size() - unescapedBegin)));
+    m_buffer.append('"');
+}
+
+template <typename Map>
+void JsonWriter::writeObject(const Map &map)
+{
+    m_buffer.append('{');
+    for (auto iter = map.cbegin(); iter != map.cend(); ++iter)
+    {
+        if (iter != map.cbegin())
+            m_buffer.append(',');
+        writeString(iter.key());
+        m_buffer.append(':');
+        writeValue(iter.value());
+    }
+    m_buffer.append('}');
+}
+
+template <typename List>
+void JsonWriter::writeArray(const List &list)
+{
+    m_buffer.append('[');
+    for (auto iter = list.cbegin(); iter != list.cend(); ++iter)
+    {
+        if (iter != list.cbegin())
+            m_buffer.append(',');
+        writeValue(*iter);
+    }
+    m_buffer.append(']');
+}
@@ -36,14 +36,6 @@
 #include "base/logger.h"
 #include "base/utils/string.h"
 
-const char KEY_LOG_ID[] = "id";
-const char KEY_LOG_TIMESTAMP[] = "timestamp";
-const char KEY_LOG_MSG_TYPE[] = "type";
-const char KEY_LOG_MSG_MESSAGE[] = "message";
-const char KEY_LOG_PEER_IP[] = "ip";
-const char KEY_LOG_PEER_BLOCKED[] = "blocked";
-const char KEY_LOG_PEER_REASON[] = "reason";
-
 // Returns the log in JSON format.
 // The return value is an array of dictionaries.
 // The dictionary keys are:
@@ -30,6 +30,15 @@
 
 #include "apicontroller.h"
 
+// Log keys
+inline const char KEY_LOG_ID[] = "id";
+inline const char KEY_LOG_TIMESTAMP[] = "timestamp";
+inline const char KEY_LOG_MSG_TYPE[] = "type";
+inline const char KEY_LOG_MSG_MESSAGE[] = "message";
+inline const char KEY_LOG_PEER_IP[] = "ip";
+inline const char KEY_LOG_PEER_BLOCKED[] = "blocked";
+inline const char KEY_LOG_PEER_REASON[] = "reason";
+
 class LogController final : public APIController
 {
     Q_OBJECT
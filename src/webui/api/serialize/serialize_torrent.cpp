@@ -28,7 +28,9 @@
 
 #include "serialize_torrent.h"
 
+#include <QCborValue>
 #include <QDateTime>
+#include <QHash>
 #include <QVector>
 
 #include "base/bittorrent/infohash.h"
@@ -83,79 +85,159 @@ namespace
             return QLatin1String("unknown");
         }
     }
-}
 
-QVariantMap serialize(const BitTorrent::Torrent &torrent)
-{
-    const auto adjustQueuePosition = [](const int position) -> int
+    int adjustQueuePosition(const int position)
     {
         return (position < 0) ? 0 : (position + 1);
-    };
+    }
 
-    const auto adjustRatio = [](const qreal ratio) -> qreal
+    qreal adjustRatio(const qreal ratio)
     {
         return (ratio > BitTorrent::Torrent::MAX_RATIO) ? -1 : ratio;
-    };
+    }
 
-    const auto getLastActivityTime = [&torrent]() -> qlonglong
+    qlonglong lastActivityTime(const BitTorrent::Torrent &torrent)
     {
         const qlonglong timeSinceActivity = torrent.timeSinceActivity();
         return (timeSinceActivity < 0)
             ? torrent.addedTime().toSecsSinceEpoch()
             : (QDateTime::currentDateTime().toSecsSinceEpoch() - timeSinceActivity);
-    };
-
-    return {
-        {KEY_TORRENT_ID, torrent.id().toString()},
-        {KEY_TORRENT_INFOHASHV1, torrent.infoHash().v1().toString()},
-        {KEY_TORRENT_INFOHASHV2, torrent.infoHash().v2().toString()},
-        {KEY_TORRENT_NAME, torrent.name()},
-        {KEY_TORRENT_MAGNET_URI, torrent.createMagnetURI()},
-        {KEY_TORRENT_SIZE, torrent.wantedSize()},
-        {KEY_TORRENT_PROGRESS, torrent.progress()},
-        {KEY_TORRENT_DLSPEED, torrent.downloadPayloadRate()},
-        {KEY_TORRENT_UPSPEED, torrent.uploadPayloadRate()},
-        {KEY_TORRENT_QUEUE_POSITION, adjustQueuePosition(torrent.queuePosition())},
-        {KEY_TORRENT_SEEDS, torrent.seedsCount()},
-        {KEY_TORRENT_NUM_COMPLETE, torrent.totalSeedsCount()},
-        {KEY_TORRENT_LEECHS, torrent.leechsCount()},
-        {KEY_TORRENT_NUM_INCOMPLETE, torrent.totalLeechersCount()},
-
-        {KEY_TORRENT_STATE, torrentStateToString(torrent.state())},
-        {KEY_TORRENT_ETA, torrent.eta()},
-        {KEY_TORRENT_SEQUENTIAL_DOWNLOAD, torrent.isSequentialDownload()},
-        {KEY_TORRENT_FIRST_LAST_PIECE_PRIO, torrent.hasFirstLastPiecePriority()},
-
-        {KEY_TORRENT_CATEGORY, torrent.category()},
-        {KEY_TORRENT_TAGS, torrent.tags().join(QLatin1String(", "))},
-        {KEY_TORRENT_SUPER_SEEDING, torrent.superSeeding()},
-        {KEY_TORRENT_FORCE_START, torrent.isForced()},
-        {KEY_TORRENT_SAVE_PATH, Utils::Fs::toNativePath(torrent.savePath())},
-        {KEY_TORRENT_CONTENT_PATH, Utils::Fs::toNativePath(torrent.contentPath())},
-        {KEY_TORRENT_ADDED_ON, torrent.addedTime().toSecsSinceEpoch()},
-        {KEY_TORRENT_COMPLETION_ON, torrent.completedTime().toSecsSinceEpoch()},
-        {KEY_TORRENT_TRACKER, torrent.currentTracker()},
-        {KEY_TORRENT_TRACKERS_COUNT, torrent.trackers().size()},
-        {KEY_TORRENT_DL_LIMIT, torrent.downloadLimit()},
-        {KEY_TORRENT_UP_LIMIT, torrent.uploadLimit()},
-        {KEY_TORRENT_AMOUNT_DOWNLOADED, torrent.totalDownload()},
-        {KEY_TORRENT_AMOUNT_UPLOADED, torrent.totalUpload()},
-        {KEY_TORRENT_AMOUNT_DOWNLOADED_SESSION, torrent.totalPayloadDownload()},
-        {KEY_TORRENT_AMOUNT_UPLOADED_SESSION, torrent.totalPayloadUpload()},
-        {KEY_TORRENT_AMOUNT_LEFT, torrent.remainingSize()},
-        {KEY_TORRENT_AMOUNT_COMPLETED, torrent.completedSize()},
-        {KEY_TORRENT_MAX_RATIO, torrent.maxRatio()},
-        {KEY_TORRENT_MAX_SEEDING_TIME, torrent.maxSeedingTime()},
-        {KEY_TORRENT_RATIO, adjustRatio(torrent.realRatio())},
-        {KEY_TORRENT_RATIO_LIMIT, torrent.ratioLimit()},
-        {KEY_TORRENT_SEEDING_TIME_LIMIT, torrent.seedingTimeLimit()},
-        {KEY_TORRENT_LAST_SEEN_COMPLETE_TIME, torrent.lastSeenComplete().toSecsSinceEpoch()},
-        {KEY_TORRENT_AUTO_TORRENT_MANAGEMENT, torrent.isAutoTMMEnabled()},
-        {KEY_TORRENT_TIME_ACTIVE, torrent.activeTime()},
-        {KEY_TORRENT_SEEDING_TIME, torrent.seedingTime()},
-        {KEY_TORRENT_LAST_ACTIVITY_TIME, getLastActivityTime()},
-        {KEY_TORRENT_AVAILABILITY, torrent.distributedCopies()},
-
-        {KEY_TORRENT_TOTAL_SIZE, torrent.totalSize()}
-    };
+    }
+
+    // Field indexes are used as keys by compact binary formats so new fields must be appended only
+    const TorrentFields &allTorrentFields()
+    {
+        static const TorrentFields fields
+        {
+            {KEY_TORRENT_ID, [](const BitTorrent::Torrent &torrent) -> QVariant { return torrent.id().toString(); }},
+            {KEY_TORRENT_INFOHASHV1, [](const BitTorrent::Torrent &torrent) -> QVariant { return torrent.infoHash().v1().toString(); }},
+            {KEY_TORRENT_INFOHASHV2, [](const BitTorrent::Torrent &torrent) -> QVariant { return torrent.infoHash().v2().toString(); }},
+            {KEY_TORRENT_NAME, [](const BitTorrent::Torrent &torrent) -> QVariant { return torrent.name(); }},
+            {KEY_TORRENT_MAGNET_URI, [](const BitTorrent::Torrent &torrent) -> QVariant { return torrent.createMagnetURI(); }},
+            {KEY_TORRENT_SIZE, [](const BitTorrent::Torrent &torrent) -> QVariant { return torrent.wantedSize(); }},
+            {KEY_TORRENT_PROGRESS, [](const BitTorrent::Torrent &torrent) -> QVariant { return torrent.progress(); }},
+            {KEY_TORRENT_DLSPEED, [](const BitTorrent::Torrent &torrent) -> QVariant { return torrent.downloadPayloadRate(); }},
+            {KEY_TORRENT_UPSPEED, [](const BitTorrent::Torrent &torrent) -> QVariant { return torrent.uploadPayloadRate(); }},
+            {KEY_TORRENT_QUEUE_POSITION, [](const BitTorrent::Torrent &torrent) -> QVariant { return adjustQueuePosition(torrent.queuePosition()); }},
+            {KEY_TORRENT_SEEDS, [](const BitTorrent::Torrent &torrent) -> QVariant { return torrent.seedsCount(); }},
+            {KEY_TORRENT_NUM_COMPLETE, [](const BitTorrent::Torrent &torrent) -> QVariant { return torrent.totalSeedsCount(); }},
+            {KEY_TORRENT_LEECHS, [](const BitTorrent::Torrent &torrent) -> QVariant { return torrent.leechsCount(); }},
+            {KEY_TORRENT_NUM_INCOMPLETE, [](const BitTorrent::Torrent &torrent) -> QVariant { return torrent.totalLeechersCount(); }},
+
+            {KEY_TORRENT_STATE, [](const BitTorrent::Torrent &torrent) -> QVariant { return torrentStateToString(torrent.state()); }},
+            {KEY_TORRENT_ETA, [](const BitTorrent::Torrent &torrent) -> QVariant { return torrent.eta(); }},
+            {KEY_TORRENT_SEQUENTIAL_DOWNLOAD, [](const BitTorrent::Torrent &torrent) -> QVariant { return torrent.isSequentialDownload(); }},
+            {KEY_TORRENT_FIRST_LAST_PIECE_PRIO, [](const BitTorrent::Torrent &torrent) -> QVariant { return torrent.hasFirstLastPiecePriority(); }},
+
+            {KEY_TORRENT_CATEGORY, [](const BitTorrent::Torrent &torrent) -> QVariant { return torrent.category(); }},
+            {KEY_TORRENT_TAGS, [](const BitTorrent::Torrent &torrent) -> QVariant { return torrent.tags().join(QLatin1String(", ")); }},
+            {KEY_TORRENT_SUPER_SEEDING, [](const BitTorrent::Torrent &torrent) -> QVariant { return torrent.superSeeding(); }},
+            {KEY_TORRENT_FORCE_START, [](const BitTorrent::Torrent &torrent) -> QVariant { return torrent.isForced(); }},
+            {KEY_TORRENT_SAVE_PATH, [](const BitTorrent::Torrent &torrent) -> QVariant { return Utils::Fs::toNativePath(torrent.savePath()); }},
+            {KEY_TORRENT_CONTENT_PATH, [](const BitTorrent::Torrent &torrent) -> QVariant { return Utils::Fs::toNativePath(torrent.contentPath()); }},
+            {KEY_TORRENT_ADDED_ON, [](const BitTorrent::Torrent &torrent) -> QVariant { return torrent.addedTime().toSecsSinceEpoch(); }},
+            {KEY_TORRENT_COMPLETION_ON, [](const BitTorrent::Torrent &torrent) -> QVariant { return torrent.completedTime().toSecsSinceEpoch(); }},
+            {KEY_TORRENT_TRACKER, [](const BitTorrent::Torrent &torrent) -> QVariant { return torrent.currentTracker(); }},
+            {KEY_TORRENT_TRACKERS_COUNT, [](const BitTorrent::Torrent &torrent) -> QVariant { return torrent.trackers().size(); }},
+            {KEY_TORRENT_DL_LIMIT, [](const BitTorrent::Torrent &torrent) -> QVariant { return torrent.downloadLimit(); }},
+            {KEY_TORRENT_UP_LIMIT, [](const BitTorrent::Torrent &torrent) -> QVariant { return torrent.uploadLimit(); }},
+            {KEY_TORRENT_AMOUNT_DOWNLOADED, [](const BitTorrent::Torrent &torrent) -> QVariant { return torrent.totalDownload(); }},
+            {KEY_TORRENT_AMOUNT_UPLOADED, [](const BitTorrent::Torrent &torrent) -> QVariant { return torrent.totalUpload(); }},
+            {KEY_TORRENT_AMOUNT_DOWNLOADED_SESSION, [](const BitTorrent::Torrent &torrent) -> QVariant { return torrent.totalPayloadDownload(); }},
+            {KEY_TORRENT_AMOUNT_UPLOADED_SESSION, [](const BitTorrent::Torrent &torrent) -> QVariant { return torrent.totalPayloadUpload(); }},
+            {KEY_TORRENT_AMOUNT_LEFT, [](const BitTorrent::Torrent &torrent) -> QVariant { return torrent.remainingSize(); }},
+            {KEY_TORRENT_AMOUNT_COMPLETED, [](const BitTorrent::Torrent &torrent) -> QVariant { return torrent.completedSize(); }},
+            {KEY_TORRENT_MAX_RATIO, [](const BitTorrent::Torrent &torrent) -> QVariant { return torrent.maxRatio(); }},
+            {KEY_TORRENT_MAX_SEEDING_TIME, [](const BitTorrent::Torrent &torrent) -> QVariant { return torrent.maxSeedingTime(); }},
+            {KEY_TORRENT_RATIO, [](const BitTorrent::Torrent &torrent) -> QVariant { return adjustRatio(torrent.realRatio()); }},
+            {KEY_TORRENT_RATIO_LIMIT, [](const BitTorrent::Torrent &torrent) -> QVariant { return torrent.ratioLimit(); }},
+            {KEY_TORRENT_SEEDING_TIME_LIMIT, [](const BitTorrent::Torrent &torrent) -> QVariant { return torrent.seedingTimeLimit(); }},
+            {KEY_TORRENT_LAST_SEEN_COMPLETE_TIME, [](const BitTorrent::Torrent &torrent) -> QVariant { return torrent.lastSeenComplete().toSecsSinceEpoch(); }},
+            {KEY_TORRENT_AUTO_TORRENT_MANAGEMENT, [](const BitTorrent::Torrent &torrent) -> QVariant { return torrent.isAutoTMMEnabled(); }},
+            {KEY_TORRENT_TIME_ACTIVE, [](const BitTorrent::Torrent &torrent) -> QVariant { return torrent.activeTime(); }},
+            {KEY_TORRENT_SEEDING_TIME, [](const BitTorrent::Torrent &torrent) -> QVariant { return torrent.seedingTime(); }},
+            {KEY_TORRENT_LAST_ACTIVITY_TIME, [](const BitTorrent::Torrent &torrent) -> QVariant { return lastActivityTime(torrent); }},
+            {KEY_TORRENT_AVAILABILITY, [](const BitTorrent::Torrent &torrent) -> QVariant { return torrent.distributedCopies(); }},
+
+            {KEY_TORRENT_TOTAL_SIZE, [](const BitTorrent::Torrent &torrent) -> QVariant { return torrent.totalSize(); }}
+        };
+        return fields;
+    }
+
+    const QHash<QString, int> &torrentFieldIndexes()
+    {
+        static const QHash<QString, int> indexes = []()
+        {
+            QHash<QString, int> result;
+            const TorrentFields &fields = allTorrentFields();
+            for (int i = 0; i < fields.size(); ++i)
+                result.insert(fields[i].first, i);
+            return result;
+        }();
+        return indexes;
+    }
+}
+
+TorrentFields torrentFields(const QStringList &names)
+{
+    if (names.isEmpty())
+        return allTorrentFields();
+
+    TorrentFields fields;
+    fields.reserve(names.size());
+    for (const TorrentField &field : allTorrentFields())
+    {
+        if (names.contains(field.first))
+            fields.append(field);
+    }
+    return fields;
+}
+
+TorrentFieldGetter torrentFieldGetter(const QString &name)
+{
+    for (const TorrentField &field : allTorrentFields())
+    {
+        if (field.first == name)
+            return field.second;
+    }
+    return nullptr;
+}
+
+QVariantMap serialize(const BitTorrent::Torrent &torrent, const TorrentFields &fields)
+{
+    QVariantMap result;
+    for (const TorrentField &field : fields)
+        result.insert(field.first, field.second(torrent));
+    return result;
+}
+
+QVariantMap serialize(const BitTorrent::Torrent &torrent)
+{
+    return serialize(torrent, allTorrentFields());
+}
+
+QStringList torrentFieldNames()
+{
+    QStringList names;
+    names.reserve(allTorrentFields().size());
+    for (const TorrentField &field : allTorrentFields())
+        names.append(field.first);
+    return names;
+}
+
+QCborMap toIndexedFields(const QVariantMap &torrent)
+{
+    const QHash<QString, int> &indexes = torrentFieldIndexes();
+
+    QCborMap result;
+    for (auto iter = torrent.cbegin(); iter != torrent.cend(); ++iter)
+    {
+        const int index = indexes.value(iter.key(), -1);
+        const QCborValue value = QCborValue::fromVariant(iter.value());
+        if (index >= 0)
+            result.insert(index, value);
+        else
+            result.insert(iter.key(), value);
+    }
+    return result;
 }
@@ -28,7 +28,11 @@
 
 #pragma once
 
+#include <QCborMap>
+#include <QPair>
+#include <QStringList>
 #include <QVariant>
+#include <QVector>
 
 namespace BitTorrent
 {
@@ -86,4 +90,18 @@ inline const char KEY_TORRENT_TIME_ACTIVE[] = "time_active";
 inline const char KEY_TORRENT_SEEDING_TIME[] = "seeding_time";
 inline const char KEY_TORRENT_AVAILABILITY[] = "availability";
 
+using TorrentFieldGetter = QVariant (*)(const BitTorrent::Torrent &torrent);
+using TorrentField = QPair<QString, TorrentFieldGetter>;
+using TorrentFields = QVector<TorrentField>;
+
+// Returns the fields with given names (all the fields if no names are given), unknown names are ignored
+TorrentFields torrentFields(const QStringList &names = {});
+// Returns nullptr if there is no field with given name
+TorrentFieldGetter torrentFieldGetter(const QString &name);
+
+QVariantMap serialize(const BitTorrent::Torrent &torrent, const TorrentFields &fields);
 QVariantMap serialize(const BitTorrent::Torrent &torrent);
+
+// Compact binary formats key the torrent fields by their indexes in this list
+QStringList torrentFieldNames();
+QCborMap toIndexedFields(const QVariantMap &torrent);
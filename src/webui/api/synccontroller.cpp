@@ -29,9 +29,11 @@
 #include "synccontroller.h"
 
 #include <algorithm>
+#include <memory>
 
-#include <QJsonObject>
 #include <QMetaObject>
+#include <QPointer>
+#include <QSet>
 #include <QThread>
 
 #include "base/bittorrent/infohash.h"
@@ -39,15 +41,19 @@
 #include "base/bittorrent/peerinfo.h"
 #include "base/bittorrent/session.h"
 #include "base/bittorrent/torrent.h"
-#include "base/bittorrent/trackerentry.h"
 #include "base/global.h"
+#include "base/http/eventsource.h"
+#include "base/logger.h"
 #include "base/net/geoipmanager.h"
 #include "base/preferences.h"
 #include "base/utils/string.h"
 #include "apierror.h"
 #include "freediskspacechecker.h"
 #include "isessionmanager.h"
+#include "jsonwriter.h"
+#include "logcontroller.h"
 #include "serialize/serialize_torrent.h"
+#include "torrentschangelog.h"
 
 namespace
 {
@@ -110,7 +116,7 @@ namespace
     void processMap(const QVariantMap &prevData, const QVariantMap &data, QVariantMap &syncData);
     void processHash(QVariantHash prevData, const QVariantHash &data, QVariantMap &syncData, QVariantList &removedItems);
     void processList(QVariantList prevData, const QVariantList &data, QVariantList &syncData, QVariantList &removedItems);
-    QVariantMap generateSyncData(int acceptedResponseId, const QVariantMap &data, QVariantMap &lastAcceptedData, QVariantMap &lastData);
+    QVariantMap generateSyncData(qint64 acceptedResponseId, qint64 responseId, const QVariantMap &data, QVariantMap &lastAcceptedData, QVariantMap &lastData);
 
     QVariantMap getTransferInfo()
     {
@@ -328,19 +334,18 @@ namespace
         }
     }
 
-    QVariantMap generateSyncData(int acceptedResponseId, const QVariantMap &data, QVariantMap &lastAcceptedData, QVariantMap &lastData)
+    QVariantMap generateSyncData(const qint64 acceptedResponseId, const qint64 responseId, const QVariantMap &data, QVariantMap &lastAcceptedData, QVariantMap &lastData)
     {
         QVariantMap syncData;
         bool fullUpdate = true;
-        int lastResponseId = 0;
         if (acceptedResponseId > 0)
         {
-            lastResponseId = lastData[KEY_RESPONSE_ID].toInt();
+            const qint64 lastResponseId = lastData[KEY_RESPONSE_ID].toLongLong();
 
             if (lastResponseId == acceptedResponseId)
                 lastAcceptedData = lastData;
 
-            int lastAcceptedResponseId = lastAcceptedData[KEY_RESPONSE_ID].toInt();
+            const qint64 lastAcceptedResponseId = lastAcceptedData[KEY_RESPONSE_ID].toLongLong();
 
             if (lastAcceptedResponseId == acceptedResponseId)
             {
@@ -356,17 +361,121 @@ namespace
             syncData[KEY_FULL_UPDATE] = true;
         }
 
-        lastResponseId = (lastResponseId % 1000000) + 1;  // cycle between 1 and 1000000
         lastData = data;
-        lastData[KEY_RESPONSE_ID] = lastResponseId;
-        syncData[KEY_RESPONSE_ID] = lastResponseId;
+        lastData[KEY_RESPONSE_ID] = responseId;
+        syncData[KEY_RESPONSE_ID] = responseId;
 
         return syncData;
     }
+
+    // Pushes sync/maindata changes (except categories and tags) and log messages as they happen
+    class MainDataEventSource final : public Http::EventSource
+    {
+    public:
+        MainDataEventSource(TorrentsChangeLog *torrentsChangeLog, const qint64 version
+                , const QSet<QString> &torrentFields, const bool pushLog)
+            : m_torrentsChangeLog {torrentsChangeLog}
+            , m_version {version}
+            , m_torrentFields {torrentFields}
+        {
+            const auto *session = BitTorrent::Session::instance();
+            // statistics are updated once per refresh after the torrents
+            connect(session, &BitTorrent::Session::statsUpdated, this, &MainDataEventSource::pushMainData);
+
+            if (pushLog)
+                connect(Logger::instance(), &Logger::newLogMessage, this, &MainDataEventSource::pushLogMessage);
+
+            // initial data is pushed once the stream is open
+            QMetaObject::invokeMethod(this, &MainDataEventSource::pushMainData, Qt::QueuedConnection);
+        }
+
+    private:
+        void pushMainData()
+        {
+            if (!m_torrentsChangeLog)
+            {
+                emit finished();
+                return;
+            }
+
+            // The client consumes the updates so keep them coming
+            BitTorrent::Session::instance()->notifyRefreshDemand();
+
+            const qint64 version = m_torrentsChangeLog->commit();
+
+            QVariantMap data;
+            if (!m_torrentsChangeLog->canSyncFrom(m_version) || (m_version <= 0))
+            {
+                data[KEY_FULL_UPDATE] = true;
+                data["torrents"] = m_torrentsChangeLog->torrentsChangedSince(0, m_torrentFields);
+                data["trackers"] = m_torrentsChangeLog->trackersChangedSince(0);
+            }
+            else
+            {
+                const QVariantHash torrents = m_torrentsChangeLog->torrentsChangedSince(m_version, m_torrentFields);
+                if (!torrents.isEmpty())
+                    data["torrents"] = torrents;
+                const QVariantList removedTorrents = m_torrentsChangeLog->torrentsRemovedSince(m_version);
+                if (!removedTorrents.isEmpty())
+                    data["torrents_removed"] = removedTorrents;
+
+                const QVariantHash trackers = m_torrentsChangeLog->trackersChangedSince(m_version);
+                if (!trackers.isEmpty())
+                    data["trackers"] = trackers;
+                const QVariantList removedTrackers = m_torrentsChangeLog->trackersRemovedSince(m_version);
+                if (!removedTrackers.isEmpty())
+                    data["trackers_removed"] = removedTrackers;
+            }
+            m_version = version;
+
+            const QVariantMap serverState = getTransferInfo();
+            QVariantMap changedServerState;
+            for (auto iter = serverState.cbegin(); iter != serverState.cend(); ++iter)
+            {
+                if (m_serverState.value(iter.key()) != iter.value())
+                    changedServerState[iter.key()] = iter.value();
+            }
+            m_serverState = serverState;
+            if (!changedServerState.isEmpty())
+                data["server_state"] = changedServerState;
+
+            // nothing is sent to idle clients
+            if (data.isEmpty())
+                return;
+
+            data[KEY_RESPONSE_ID] = version;
+            emit eventReady(QLatin1String("maindata"), toJSON(data));
+        }
+
+        void pushLogMessage(const Log::Msg &msg)
+        {
+            const QVariantMap data
+            {
+                {KEY_LOG_ID, msg.id},
+                {KEY_LOG_TIMESTAMP, msg.timestamp},
+                {KEY_LOG_MSG_TYPE, msg.type},
+                {KEY_LOG_MSG_MESSAGE, msg.message}
+            };
+            emit eventReady(QLatin1String("log"), toJSON(data));
+        }
+
+        static QByteArray toJSON(const QVariantMap &data)
+        {
+            JsonWriter writer;
+            writer.write(data);
+            return writer.data();
+        }
+
+        QPointer<TorrentsChangeLog> m_torrentsChangeLog;
+        qint64 m_version = 0;
+        QSet<QString> m_torrentFields;
+        QVariantMap m_serverState;
+    };
 }
 
-SyncController::SyncController(ISessionManager *sessionManager, QObject *parent)
+SyncController::SyncController(TorrentsChangeLog *torrentsChangeLog, ISessionManager *sessionManager, QObject *parent)
     : APIController(sessionManager, parent)
+    , m_torrentsChangeLog {torrentsChangeLog}
 {
     m_freeDiskSpaceThread = new QThread(this);
     m_freeDiskSpaceChecker = new FreeDiskSpaceChecker();
@@ -448,53 +557,19 @@ SyncController::~SyncController()
 //  - "free_space_on_disk": Free space on the default save path
 // GET param:
 //   - rid (int): last response id
+//   - fields (string): names of the torrent fields to sync separated by | (all the fields if empty)
+//   - format (string): "cbor" to get the result in CBOR with torrent fields keyed by their indexes
 void SyncController::maindataAction()
 {
     const auto *session = BitTorrent::Session::instance();
 
     QVariantMap data;
 
+    // Torrents and trackers are synced using the change log shared by all the clients
+    // so only the rest of the data is kept in client session to compare with
     QVariantMap lastResponse = sessionManager()->session()->getData(QLatin1String("syncMainDataLastResponse")).toMap();
     QVariantMap lastAcceptedResponse = sessionManager()->session()->getData(QLatin1String("syncMainDataLastAcceptedResponse")).toMap();
 
-    QVariantHash torrents;
-    QHash<QString, QStringList> trackers;
-    for (const BitTorrent::Torrent *torrent : asConst(session->torrents()))
-    {
-        const BitTorrent::TorrentID torrentID = torrent->id();
-
-        QVariantMap map = serialize(*torrent);
-        map.remove(KEY_TORRENT_ID);
-
-        // Calculated last activity time can differ from actual value by up to 10 seconds (this is a libtorrent issue).
-        // So we don't need unnecessary updates of last activity time in response.
-        const auto iterTorrents = lastResponse.find("torrents");
-        if (iterTorrents != lastResponse.end())
-        {
-            const QVariantHash lastResponseTorrents = iterTorrents->toHash();
-            const auto iterID = lastResponseTorrents.find(torrentID.toString());
-
-            if (iterID != lastResponseTorrents.end())
-            {
-                const QVariantMap torrentData = iterID->toMap();
-                const auto iterLastActivity = torrentData.find(KEY_TORRENT_LAST_ACTIVITY_TIME);
-
-                if (iterLastActivity != torrentData.end())
-                {
-                    const int lastValue = iterLastActivity->toInt();
-                    if (qAbs(lastValue - map[KEY_TORRENT_LAST_ACTIVITY_TIME].toInt()) < 15)
-                        map[KEY_TORRENT_LAST_ACTIVITY_TIME] = lastValue;
-                }
-            }
-        }
-
-        for (const BitTorrent::TrackerEntry &tracker : asConst(torrent->trackers()))
-            trackers[tracker.url] << torrentID.toString();
-
-        torrents[torrentID.toString()] = map;
-    }
-    data["torrents"] = torrents;
-
     QVariantHash categories;
     const QStringMap categoriesList = session->categories();
     for (auto it = categoriesList.cbegin(); it != categoriesList.cend(); ++it)
@@ -513,13 +588,6 @@ void SyncController::maindataAction()
         tags << tag;
     data["tags"] = tags;
 
-    QVariantHash trackersHash;
-    for (auto i = trackers.constBegin(); i != trackers.constEnd(); ++i)
-    {
-        trackersHash[i.key()] = i.value();
-    }
-    data["trackers"] = trackersHash;
-
     QVariantMap serverState = getTransferInfo();
     serverState[KEY_TRANSFER_FREESPACEONDISK] = getFreeDiskSpace();
     serverState[KEY_SYNC_MAINDATA_QUEUEING] = session->isQueueingSystemEnabled();
@@ -527,8 +595,46 @@ void SyncController::maindataAction()
     serverState[KEY_SYNC_MAINDATA_REFRESH_INTERVAL] = session->refreshInterval();
     data["server_state"] = serverState;
 
-    const int acceptedResponseId {params()["rid"].toInt()};
-    setResult(QJsonObject::fromVariantMap(generateSyncData(acceptedResponseId, data, lastAcceptedResponse, lastResponse)));
+    const qint64 responseId = m_torrentsChangeLog->commit();
+    qint64 acceptedResponseId {params()["rid"].toLongLong()};
+    if (!m_torrentsChangeLog->canSyncFrom(acceptedResponseId))
+        acceptedResponseId = 0;
+
+    QSet<QString> torrentFields;
+    for (const QString &field : asConst(params()["fields"].split('|', Qt::SkipEmptyParts)))
+        torrentFields.insert(field);
+
+    QVariantMap syncData = generateSyncData(acceptedResponseId, responseId, data, lastAcceptedResponse, lastResponse);
+    if (syncData.value(KEY_FULL_UPDATE).toBool())
+    {
+        syncData["torrents"] = m_torrentsChangeLog->torrentsChangedSince(0, torrentFields);
+        syncData["trackers"] = m_torrentsChangeLog->trackersChangedSince(0);
+    }
+    else
+    {
+        const QVariantHash torrents = m_torrentsChangeLog->torrentsChangedSince(acceptedResponseId, torrentFields);
+        if (!torrents.isEmpty())
+            syncData["torrents"] = torrents;
+        const QVariantList removedTorrents = m_torrentsChangeLog->torrentsRemovedSince(acceptedResponseId);
+        if (!removedTorrents.isEmpty())
+            syncData["torrents_removed"] = removedTorrents;
+
+        const QVariantHash trackers = m_torrentsChangeLog->trackersChangedSince(acceptedResponseId);
+        if (!trackers.isEmpty())
+            syncData["trackers"] = trackers;
+        const QVariantList removedTrackers = m_torrentsChangeLog->trackersRemovedSince(acceptedResponseId);
+        if (!removedTrackers.isEmpty())
+            syncData["trackers_removed"] = removedTrackers;
+    }
+    if (isCBORRequested() && syncData.contains(QLatin1String("torrents")))
+    {
+        QVariantHash torrents = syncData.value(QLatin1String("torrents")).toHash();
+        for (QVariant &torrent : torrents)
+            torrent = QVariant::fromValue(toIndexedFields(torrent.toMap()));
+        syncData[QLatin1String("torrents")] = torrents;
+    }
+
+    setResult(syncData);
 
     sessionManager()->session()->setData(QLatin1String("syncMainDataLastResponse"), lastResponse);
     sessionManager()->session()->setData(QLatin1String("syncMainDataLastAcceptedResponse"), lastAcceptedResponse);
@@ -590,12 +696,39 @@ void SyncController::torrentPeersAction()
     data["peers"] = peers;
 
     const int acceptedResponseId {params()["rid"].toInt()};
-    setResult(QJsonObject::fromVariantMap(generateSyncData(acceptedResponseId, data, lastAcceptedResponse, lastResponse)));
+    const int responseId = (lastResponse[KEY_RESPONSE_ID].toInt() % 1000000) + 1;  // cycle between 1 and 1000000
+    setResult(generateSyncData(acceptedResponseId, responseId, data, lastAcceptedResponse, lastResponse));
 
     sessionManager()->session()->setData(QLatin1String("syncTorrentPeersLastResponse"), lastResponse);
     sessionManager()->session()->setData(QLatin1String("syncTorrentPeersLastAcceptedResponse"), lastAcceptedResponse);
 }
 
+// Opens the stream of server-sent events that push the changes as they happen
+// so the client doesn't need to poll sync/maindata.
+// Events:
+//   - "maindata": the changes of torrents, trackers and server state in the format of sync/maindata
+//     (the first event contains the changes since "rid")
+//   - "log": new log message in the format of log/main
+// GET params:
+//   - rid (int): last response id of sync/maindata (or of "maindata" event) known to the client
+//   - fields (string): names of the torrent fields to push separated by | (all the fields if empty)
+//   - log (bool): push log messages (default false)
+void SyncController::eventsAction()
+{
+    qint64 version {params()["rid"].toLongLong()};
+    if (!m_torrentsChangeLog->canSyncFrom(version))
+        version = 0;
+
+    QSet<QString> torrentFields;
+    for (const QString &field : asConst(params()["fields"].split('|', Qt::SkipEmptyParts)))
+        torrentFields.insert(field);
+
+    const bool pushLog = Utils::String::parseBool(params()["log"]).value_or(false);
+
+    setEventSource({new MainDataEventSource(m_torrentsChangeLog, version, torrentFields, pushLog)
+        , [](QObject *eventSource) { eventSource->deleteLater(); }});
+}
+
 qint64 SyncController::getFreeDiskSpace()
 {
     if (m_freeDiskSpaceElapsedTimer.hasExpired(FREEDISKSPACE_CHECK_TIMEOUT))
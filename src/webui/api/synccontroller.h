@@ -37,6 +37,7 @@ struct ISessionManager;
 class QThread;
 
 class FreeDiskSpaceChecker;
+class TorrentsChangeLog;
 
 class SyncController : public APIController
 {
@@ -44,14 +45,13 @@ class SyncController : public APIController
     Q_DISABLE_COPY_MOVE(SyncController)
 
 public:
-    using APIController::APIController;
-
-    explicit SyncController(ISessionManager *sessionManager, QObject *parent = nullptr);
+    SyncController(TorrentsChangeLog *torrentsChangeLog, ISessionManager *sessionManager, QObject *parent = nullptr);
     ~SyncController() override;
 
 private slots:
     void maindataAction();
     void torrentPeersAction();
+    void eventsAction();
     void freeDiskSpaceSizeUpdated(qint64 freeSpaceSize);
 
 private:
@@ -62,4 +62,6 @@ private:
     FreeDiskSpaceChecker *m_freeDiskSpaceChecker = nullptr;
     QThread *m_freeDiskSpaceThread = nullptr;
     QElapsedTimer m_freeDiskSpaceElapsedTimer;
+
+    TorrentsChangeLog *m_torrentsChangeLog = nullptr;
 };
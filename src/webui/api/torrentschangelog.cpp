@@ -0,0 +1,321 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2021  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+#include "torrentschangelog.h"
+
+#include <algorithm>
+
+#include "base/bittorrent/session.h"
+#include "base/bittorrent/torrent.h"
+#include "base/bittorrent/trackerentry.h"
+#include "base/global.h"
+#include "serialize/serialize_torrent.h"
+
+namespace
+{
+    // Clients that are behind the oldest kept removed item get full update
+    const int MAX_REMOVED_ITEMS = 1000;
+}
+
+TorrentsChangeLog::TorrentsChangeLog(QObject *parent)
+    : QObject(parent)
+{
+    const auto *session = BitTorrent::Session::instance();
+
+    connect(session, &BitTorrent::Session::torrentLoaded, this, &TorrentsChangeLog::markChanged);
+    connect(session, &BitTorrent::Session::torrentAboutToBeRemoved, this, &TorrentsChangeLog::markRemoved);
+    connect(session, &BitTorrent::Session::torrentsUpdated, this, [this](const QVector<BitTorrent::Torrent *> &torrents)
+    {
+        for (const BitTorrent::Torrent *torrent : torrents)
+            markChanged(torrent);
+    });
+    connect(session, &BitTorrent::Session::torrentCategoryChanged, this, &TorrentsChangeLog::markChanged);
+    connect(session, &BitTorrent::Session::torrentTagAdded, this, &TorrentsChangeLog::markChanged);
+    connect(session, &BitTorrent::Session::torrentTagRemoved, this, &TorrentsChangeLog::markChanged);
+    connect(session, &BitTorrent::Session::torrentSavePathChanged, this, &TorrentsChangeLog::markChanged);
+    connect(session, &BitTorrent::Session::torrentSavingModeChanged, this, &TorrentsChangeLog::markChanged);
+    connect(session, &BitTorrent::Session::torrentMetadataReceived, this, &TorrentsChangeLog::markChanged);
+    connect(session, &BitTorrent::Session::torrentPaused, this, &TorrentsChangeLog::markChanged);
+    connect(session, &BitTorrent::Session::torrentResumed, this, &TorrentsChangeLog::markChanged);
+    connect(session, &BitTorrent::Session::torrentFinished, this, &TorrentsChangeLog::markChanged);
+    connect(session, &BitTorrent::Session::torrentFinishedChecking, this, &TorrentsChangeLog::markChanged);
+    connect(session, &BitTorrent::Session::torrentPropertiesChanged, this, &TorrentsChangeLog::markChanged);
+    connect(session, &BitTorrent::Session::trackersChanged, this, &TorrentsChangeLog::markChanged);
+
+    for (const BitTorrent::Torrent *torrent : asConst(session->torrents()))
+        markChanged(torrent);
+}
+
+qint64 TorrentsChangeLog::commit()
+{
+    ++m_version;
+
+    for (const BitTorrent::TorrentID &id : asConst(m_removedTorrentIDs))
+        removeTorrent(id);
+    m_removedTorrentIDs.clear();
+
+    const auto *session = BitTorrent::Session::instance();
+    for (const BitTorrent::TorrentID &id : asConst(m_changedTorrents))
+    {
+        const BitTorrent::Torrent *torrent = session->findTorrent(id);
+        if (torrent)
+            updateTorrent(*torrent);
+    }
+    m_changedTorrents.clear();
+
+    pruneRemovedItems();
+
+    return m_version;
+}
+
+bool TorrentsChangeLog::canSyncFrom(const qint64 version) const
+{
+    return ((version >= m_oldestVersion) && (version <= m_version));
+}
+
+QVariantMap TorrentsChangeLog::torrentData(const BitTorrent::TorrentID &id) const
+{
+    const auto iter = m_torrents.constFind(id);
+    return (iter != m_torrents.cend()) ? iter->fields : QVariantMap();
+}
+
+QVariant TorrentsChangeLog::torrentField(const BitTorrent::TorrentID &id, const QString &field) const
+{
+    const auto iter = m_torrents.constFind(id);
+    return (iter != m_torrents.cend()) ? iter->fields.value(field) : QVariant();
+}
+
+QVariantHash TorrentsChangeLog::torrentsChangedSince(const qint64 version, const QSet<QString> &fields) const
+{
+    QVariantHash result;
+    for (auto iter = m_torrentsByVersion.upperBound(version); iter != m_torrentsByVersion.cend(); ++iter)
+    {
+        const TorrentData &data = *m_torrents.constFind(iter.value());
+        if ((version <= 0) && fields.isEmpty())
+        {
+            QVariantMap allFields = data.fields;
+            allFields.remove(KEY_TORRENT_ID);
+            result[data.id] = allFields;
+            continue;
+        }
+
+        QVariantMap changedFields;
+        for (auto i = data.fieldVersions.cbegin(); i != data.fieldVersions.cend(); ++i)
+        {
+            if ((i.value() > version) && (i.key() != QLatin1String(KEY_TORRENT_ID))
+                && (fields.isEmpty() || fields.contains(i.key())))
+            {
+                changedFields[i.key()] = data.fields.value(i.key());
+            }
+        }
+        // Torrent could be changed in the fields that aren't requested only
+        if ((version <= 0) || !changedFields.isEmpty())
+            result[data.id] = changedFields;
+    }
+
+    return result;
+}
+
+QVariantList TorrentsChangeLog::torrentsRemovedSince(const qint64 version) const
+{
+    QSet<QString> removedTorrents;
+    for (auto iter = m_removedTorrents.crbegin(); (iter != m_removedTorrents.crend()) && (iter->version > version); ++iter)
+    {
+        // Torrent could be added again
+        if (!m_torrents.contains(BitTorrent::TorrentID::fromString(iter->key)))
+            removedTorrents.insert(iter->key);
+    }
+
+    QVariantList result;
+    result.reserve(removedTorrents.size());
+    for (const QString &id : asConst(removedTorrents))
+        result << id;
+    return result;
+}
+
+QVariantHash TorrentsChangeLog::trackersChangedSince(const qint64 version) const
+{
+    QVariantHash result;
+    for (auto iter = m_trackers.cbegin(); iter != m_trackers.cend(); ++iter)
+    {
+        if (iter->version <= version)
+            continue;
+
+        QStringList torrents;
+        torrents.reserve(iter->torrents.size());
+        for (const QString &id : asConst(iter->torrents))
+            torrents << id;
+        result[iter.key()] = torrents;
+    }
+
+    return result;
+}
+
+QVariantList TorrentsChangeLog::trackersRemovedSince(const qint64 version) const
+{
+    QSet<QString> removedTrackers;
+    for (auto iter = m_removedTrackers.crbegin(); (iter != m_removedTrackers.crend()) && (iter->version > version); ++iter)
+    {
+        // Tracker could be added again
+        if (!m_trackers.contains(iter->key))
+            removedTrackers.insert(iter->key);
+    }
+
+    QVariantList result;
+    result.reserve(removedTrackers.size());
+    for (const QString &url : asConst(removedTrackers))
+        result << url;
+    return result;
+}
+
+void TorrentsChangeLog::markChanged(const BitTorrent::Torrent *torrent)
+{
+    m_changedTorrents.insert(torrent->id());
+}
+
+void TorrentsChangeLog::markRemoved(const BitTorrent::Torrent *torrent)
+{
+    m_changedTorrents.remove(torrent->id());
+    m_removedTorrentIDs.insert(torrent->id());
+}
+
+void TorrentsChangeLog::updateTorrent(const BitTorrent::Torrent &torrent)
+{
+    const BitTorrent::TorrentID id = torrent.id();
+
+    const QVariantMap fields = serialize(torrent);
+
+    TorrentData &data = m_torrents[id];
+    if (data.id.isEmpty())
+        data.id = id.toString();
+
+    bool isChanged = false;
+    for (auto i = fields.cbegin(); i != fields.cend(); ++i)
+    {
+        const auto prevIter = data.fields.find(i.key());
+        if (prevIter != data.fields.end())
+        {
+            if (prevIter.value() == i.value())
+                continue;
+
+            // Calculated last activity time can differ from actual value by up to 10 seconds (this is a libtorrent issue).
+            // So we don't need unnecessary updates of last activity time in response.
+            if ((i.key() == QLatin1String(KEY_TORRENT_LAST_ACTIVITY_TIME))
+                && (qAbs(prevIter.value().toLongLong() - i.value().toLongLong()) < 15))
+            {
+                continue;
+            }
+
+            prevIter.value() = i.value();
+        }
+        else
+        {
+            data.fields.insert(i.key(), i.value());
+        }
+
+        data.fieldVersions[i.key()] = m_version;
+        isChanged = true;
+    }
+
+    if (isChanged)
+    {
+        m_torrentsByVersion.remove(data.version, id);
+        data.version = m_version;
+        m_torrentsByVersion.insert(data.version, id);
+    }
+
+    QSet<QString> trackers;
+    for (const BitTorrent::TrackerEntry &tracker : asConst(torrent.trackers()))
+        trackers.insert(tracker.url);
+
+    for (const QString &trackerURL : asConst(data.trackers))
+    {
+        if (!trackers.contains(trackerURL))
+            removeTorrentFromTracker(trackerURL, data.id);
+    }
+    for (const QString &trackerURL : asConst(trackers))
+    {
+        if (!data.trackers.contains(trackerURL))
+            addTorrentToTracker(trackerURL, data.id);
+    }
+    data.trackers = trackers;
+}
+
+void TorrentsChangeLog::removeTorrent(const BitTorrent::TorrentID &id)
+{
+    const auto iter = m_torrents.find(id);
+    if (iter == m_torrents.end())
+        return;
+
+    for (const QString &trackerURL : asConst(iter->trackers))
+        removeTorrentFromTracker(trackerURL, iter->id);
+
+    m_torrentsByVersion.remove(iter->version, id);
+    m_removedTorrents.append({m_version, iter->id});
+    m_torrents.erase(iter);
+}
+
+void TorrentsChangeLog::addTorrentToTracker(const QString &trackerURL, const QString &torrentID)
+{
+    TrackerData &trackerData = m_trackers[trackerURL];
+    trackerData.torrents.insert(torrentID);
+    trackerData.version = m_version;
+}
+
+void TorrentsChangeLog::removeTorrentFromTracker(const QString &trackerURL, const QString &torrentID)
+{
+    const auto iter = m_trackers.find(trackerURL);
+    if (iter == m_trackers.end())
+        return;
+
+    iter->torrents.remove(torrentID);
+    if (iter->torrents.isEmpty())
+    {
+        m_trackers.erase(iter);
+        m_removedTrackers.append({m_version, trackerURL});
+    }
+    else
+    {
+        iter->version = m_version;
+    }
+}
+
+void TorrentsChangeLog::pruneRemovedItems()
+{
+    const auto prune = [this](QVector<RemovedItem> &items)
+    {
+        if (items.size() <= MAX_REMOVED_ITEMS)
+            return;
+
+        const int count = items.size() - MAX_REMOVED_ITEMS;
+        m_oldestVersion = std::max(m_oldestVersion, items[count - 1].version);
+        items.remove(0, count);
+    };
+
+    prune(m_removedTorrents);
+    prune(m_removedTrackers);
+}
@@ -0,0 +1,117 @@
+/*
+ * Bittorrent Client using Qt and libtorrent.
+ * Copyright (C) 2021  qBittorrent project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link this program with the OpenSSL project's "OpenSSL" library (or with
+ * modified versions of it that use the same license as the "OpenSSL" library),
+ * and distribute the linked executables. You must obey the GNU General Public
+ * License in all respects for all of the code used other than "OpenSSL".  If you
+ * modify file(s), you may extend this exception to your version of the file(s),
+ * but you are not obligated to do so. If you do not wish to do so, delete this
+ * exception statement from your version.
+ */
+#pragma once
+
+#include <QHash>
+#include <QMultiMap>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <QVector>
+
+#include "base/bittorrent/infohash.h"
+
+namespace BitTorrent
+{
+    class Torrent;
+}
+
+// Session-wide log of torrents (and their trackers) data changes used to sync WebUI clients.
+// Each commit serializes only the torrents changed since the previous one and stamps
+// the changed fields with the new version, so any client can get the changes made
+// since the version it has by looking at the changed torrents only.
+// The serialized torrents are also shared by all the clients and API endpoints
+// so the torrent is serialized at most once per refresh no matter how many requests there are.
+class TorrentsChangeLog final : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(TorrentsChangeLog)
+
+public:
+    explicit TorrentsChangeLog(QObject *parent = nullptr);
+
+    // Applies pending changes and returns the new version
+    qint64 commit();
+    // Whether the changes since given version are still available
+    bool canSyncFrom(qint64 version) const;
+
+    // Serialized torrent as of the last commit
+    QVariantMap torrentData(const BitTorrent::TorrentID &id) const;
+    QVariant torrentField(const BitTorrent::TorrentID &id, const QString &field) const;
+
+    // Pass 0 to get the whole data, pass no fields to get all of them
+    QVariantHash torrentsChangedSince(qint64 version, const QSet<QString> &fields = {}) const;
+    QVariantList torrentsRemovedSince(qint64 version) const;
+    QVariantHash trackersChangedSince(qint64 version) const;
+    QVariantList trackersRemovedSince(qint64 version) const;
+
+private:
+    struct TorrentData
+    {
+        QString id;
+        QVariantMap fields;
+        QHash<QString, qint64> fieldVersions;
+        qint64 version = 0;
+        QSet<QString> trackers;
+    };
+
+    struct TrackerData
+    {
+        QSet<QString> torrents;
+        qint64 version = 0;
+    };
+
+    struct RemovedItem
+    {
+        qint64 version;
+        QString key;
+    };
+
+    void markChanged(const BitTorrent::Torrent *torrent);
+    void markRemoved(const BitTorrent::Torrent *torrent);
+    void updateTorrent(const BitTorrent::Torrent &torrent);
+    void removeTorrent(const BitTorrent::TorrentID &id);
+    void addTorrentToTracker(const QString &trackerURL, const QString &torrentID);
+    void removeTorrentFromTracker(const QString &trackerURL, const QString &torrentID);
+    void pruneRemovedItems();
+
+    qint64 m_version = 0;
+    // Changes since the versions prior to this one can't be reconstructed since removed items are pruned
+    qint64 m_oldestVersion = 0;
+
+    QSet<BitTorrent::TorrentID> m_changedTorrents;
+    QSet<BitTorrent::TorrentID> m_removedTorrentIDs;
+
+    QHash<BitTorrent::TorrentID, TorrentData> m_torrents;
+    QMultiMap<qint64, BitTorrent::TorrentID> m_torrentsByVersion;
+    QHash<QString, TrackerData> m_trackers;
+    QVector<RemovedItem> m_removedTorrents;
+    QVector<RemovedItem> m_removedTrackers;
+};
@@ -28,7 +28,11 @@
 
 #include "torrentscontroller.h"
 
+#include <algorithm>
 #include <functional>
+#include <utility>
+#include <variant>
+#include <vector>
 
 #include <QBitArray>
 #include <QDir>
@@ -56,6 +60,7 @@
 #include "base/utils/string.h"
 #include "apierror.h"
 #include "serialize/serialize_torrent.h"
+#include "torrentschangelog.h"
 
 // Tracker keys
 const char KEY_TRACKER_URL[] = "url";
@@ -212,6 +217,30 @@ namespace
         return {dht, pex, lsd};
     }
 
+    using SortKey = std::variant<bool, qlonglong, double, QString>;
+
+    SortKey toSortKey(const QVariant &value)
+    {
+        switch (static_cast<QMetaType::Type>(value.type()))
+        {
+        case QMetaType::Bool:
+            return value.toBool();
+        case QMetaType::Int:
+        case QMetaType::LongLong:
+            return value.toLongLong();
+        case QMetaType::Float:
+        case QMetaType::Double:
+            return value.toDouble();
+        case QMetaType::QString:
+            return value.toString();
+        default:
+            qWarning("Unhandled QVariant comparison, type: %d, name: %s", value.type()
+                , QMetaType::typeName(value.type()));
+            break;
+        }
+        return {};
+    }
+
     QVector<BitTorrent::TorrentID> toTorrentIDs(const QStringList &idStrings)
     {
         QVector<BitTorrent::TorrentID> idList;
@@ -222,6 +251,12 @@ namespace
     }
 }
 
+TorrentsController::TorrentsController(TorrentsChangeLog *torrentsChangeLog, ISessionManager *sessionManager, QObject *parent)
+    : APIController(sessionManager, parent)
+    , m_torrentsChangeLog {torrentsChangeLog}
+{
+}
+
 // Returns all the torrents in JSON format.
 // The return value is a JSON-formatted list of dictionaries.
 // The dictionary keys are:
@@ -252,6 +287,8 @@ namespace
 //   - reverse (bool): enable reverse sorting
 //   - limit (int): set limit number of torrents returned (if greater than 0, otherwise - unlimited)
 //   - offset (int): set offset (if less than 0 - offset from end)
+//   - fields (string): names of the returned fields separated by | (all the fields if empty)
+//   - format (string): "cbor" to get the result in CBOR with torrent fields keyed by their indexes (see fieldsAction())
 void TorrentsController::infoAction()
 {
     const QString filter {params()["filter"]};
@@ -262,79 +299,99 @@ void TorrentsController::infoAction()
     int limit {params()["limit"].toInt()};
     int offset {params()["offset"].toInt()};
     const QStringList hashes {params()["hashes"].split('|', Qt::SkipEmptyParts)};
+    const QStringList fieldNames {params()["fields"].split('|', Qt::SkipEmptyParts)};
 
     TorrentIDSet idSet;
     for (const QString &hash : hashes)
         idSet.insert(BitTorrent::TorrentID::fromString(hash));
 
     const TorrentFilter torrentFilter(filter, (hashes.isEmpty() ? TorrentFilter::AnyID : idSet), category, tag);
-    QVariantList torrentList;
-    for (const BitTorrent::Torrent *torrent : asConst(BitTorrent::Session::instance()->torrents()))
-    {
-        if (torrentFilter.match(torrent))
-            torrentList.append(serialize(*torrent));
-    }
-
-    if (torrentList.isEmpty())
+    QVector<BitTorrent::Torrent *> torrents = BitTorrent::Session::instance()->torrents(torrentFilter);
+    if (torrents.isEmpty())
     {
         setResult(QJsonArray {});
         return;
     }
 
-    if (!sortedColumn.isEmpty())
+    const int size = torrents.size();
+    // normalize offset
+    if (offset < 0)
+        offset = size + offset;
+    if ((offset >= size) || (offset < 0))
+        offset = 0;
+    // normalize limit
+    if ((limit <= 0) || (limit > (size - offset)))
+        limit = size - offset;
+    const int end = offset + limit;
+
+    const TorrentFieldGetter sortKeyGetter = sortedColumn.isEmpty() ? nullptr : torrentFieldGetter(sortedColumn);
+    if (!sortedColumn.isEmpty() && !sortKeyGetter)
+        throw APIError(APIErrorType::BadParams, tr("'sort' parameter is invalid"));
+
+    // Without projection the serialized torrents are shared with other requests until the torrents are changed.
+    // Projection is cheaper to compute on the spot for the returned page only.
+    // Either way the values used for sorting come from the same source as the returned ones.
+    const bool useChangeLog = fieldNames.isEmpty();
+    if (useChangeLog)
+        m_torrentsChangeLog->commit();
+
+    if (sortKeyGetter)
     {
-        if (!torrentList[0].toMap().contains(sortedColumn))
-            throw APIError(APIErrorType::BadParams, tr("'sort' parameter is invalid"));
-
-        const auto lessThan = [](const QVariant &left, const QVariant &right) -> bool
+        // Extract the sort key of each torrent once instead of doing it on each comparison
+        std::vector<std::pair<SortKey, BitTorrent::Torrent *>> sortItems;
+        sortItems.reserve(torrents.size());
+        for (BitTorrent::Torrent *torrent : torrents)
         {
-            Q_ASSERT(left.type() == right.type());
+            const QVariant sortKey = useChangeLog
+                ? m_torrentsChangeLog->torrentField(torrent->id(), sortedColumn)
+                : sortKeyGetter(*torrent);
+            sortItems.emplace_back(toSortKey(sortKey), torrent);
+        }
 
-            switch (static_cast<QMetaType::Type>(left.type()))
-            {
-            case QMetaType::Bool:
-                return left.value<bool>() < right.value<bool>();
-            case QMetaType::Double:
-                return left.value<double>() < right.value<double>();
-            case QMetaType::Float:
-                return left.value<float>() < right.value<float>();
-            case QMetaType::Int:
-                return left.value<int>() < right.value<int>();
-            case QMetaType::LongLong:
-                return left.value<qlonglong>() < right.value<qlonglong>();
-            case QMetaType::QString:
-                return left.value<QString>() < right.value<QString>();
-            default:
-                qWarning("Unhandled QVariant comparison, type: %d, name: %s", left.type()
-                    , QMetaType::typeName(left.type()));
-                break;
-            }
-            return false;
+        const auto lessThan = [reverse](const std::pair<SortKey, BitTorrent::Torrent *> &left, const std::pair<SortKey, BitTorrent::Torrent *> &right)
+        {
+            return reverse ? (right.first < left.first) : (left.first < right.first);
         };
 
-        std::sort(torrentList.begin(), torrentList.end()
-            , [reverse, &sortedColumn, &lessThan](const QVariant &torrent1, const QVariant &torrent2)
-        {
-            const QVariant value1 {torrent1.toMap().value(sortedColumn)};
-            const QVariant value2 {torrent2.toMap().value(sortedColumn)};
-            return reverse ? lessThan(value2, value1) : lessThan(value1, value2);
-        });
+        // Only the requested page needs to be in order
+        if (end < size)
+            std::partial_sort(sortItems.begin(), (sortItems.begin() + end), sortItems.end(), lessThan);
+        else
+            std::sort(sortItems.begin(), sortItems.end(), lessThan);
+
+        for (int i = offset; i < end; ++i)
+            torrents[i] = sortItems[i].second;
     }
 
-    const int size = torrentList.size();
-    // normalize offset
-    if (offset < 0)
-        offset = size + offset;
-    if ((offset >= size) || (offset < 0))
-        offset = 0;
-    // normalize limit
-    if (limit <= 0)
-        limit = -1; // unlimited
+    QVariantList torrentList;
+    torrentList.reserve(limit);
 
-    if ((limit > 0) || (offset > 0))
-        torrentList = torrentList.mid(offset, limit);
+    if (useChangeLog)
+    {
+        for (int i = offset; i < end; ++i)
+            torrentList.append(m_torrentsChangeLog->torrentData(torrents[i]->id()));
+    }
+    else
+    {
+        const TorrentFields fields = torrentFields(fieldNames);
+        for (int i = offset; i < end; ++i)
+            torrentList.append(serialize(*torrents[i], fields));
+    }
 
-    setResult(QJsonArray::fromVariantList(torrentList));
+    if (isCBORRequested())
+    {
+        for (QVariant &torrent : torrentList)
+            torrent = QVariant::fromValue(toIndexedFields(torrent.toMap()));
+    }
+
+    setResult(torrentList);
+}
+
+// Returns the names of torrent fields in the order of their indexes
+// that are used as the keys of torrent fields in compact binary formats (e.g. CBOR).
+void TorrentsController::fieldsAction()
+{
+    setResult(QJsonArray::fromStringList(torrentFieldNames()));
 }
 
 // Returns the properties for a torrent in JSON format.
@@ -30,16 +30,19 @@
 
 #include "apicontroller.h"
 
+class TorrentsChangeLog;
+
 class TorrentsController : public APIController
 {
     Q_OBJECT
     Q_DISABLE_COPY_MOVE(TorrentsController)
 
 public:
-    using APIController::APIController;
+    TorrentsController(TorrentsChangeLog *torrentsChangeLog, ISessionManager *sessionManager, QObject *parent = nullptr);
 
 private slots:
     void infoAction();
+    void fieldsAction();
     void propertiesAction();
     void trackersAction();
     void webseedsAction();
@@ -85,4 +88,7 @@ private slots:
     void toggleFirstLastPiecePrioAction();
     void renameFileAction();
     void renameFolderAction();
+
+private:
+    TorrentsChangeLog *m_torrentsChangeLog = nullptr;
 };
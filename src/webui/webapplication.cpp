@@ -29,7 +29,9 @@
 #include "webapplication.h"
 
 #include <algorithm>
+#include <memory>
 
+#include <QCryptographicHash>
 #include <QDateTime>
 #include <QDebug>
 #include <QFile>
@@ -39,31 +41,46 @@
 #include <QMimeType>
 #include <QNetworkCookie>
 #include <QRegularExpression>
+#include <QTimer>
 #include <QUrl>
 
 #include "base/algorithm.h"
+#include "base/bittorrent/session.h"
 #include "base/global.h"
+#include "base/http/eventsource.h"
 #include "base/http/httperror.h"
+#include "base/http/responsegenerator.h"
 #include "base/logger.h"
 #include "base/preferences.h"
 #include "base/types.h"
 #include "base/utils/bytearray.h"
 #include "base/utils/fs.h"
+#include "base/utils/gzip.h"
 #include "base/utils/misc.h"
 #include "base/utils/random.h"
 #include "base/utils/string.h"
+#include "api/apicontroller.h"
 #include "api/apierror.h"
 #include "api/appcontroller.h"
 #include "api/authcontroller.h"
+#include "api/cborwriter.h"
+#include "api/jsonwriter.h"
 #include "api/logcontroller.h"
 #include "api/rsscontroller.h"
 #include "api/searchcontroller.h"
 #include "api/synccontroller.h"
+#include "api/torrentschangelog.h"
 #include "api/torrentscontroller.h"
 #include "api/transfercontroller.h"
 
 const int MAX_ALLOWED_FILESIZE = 10 * 1024 * 1024;
+const qint64 MAX_STATIC_FILES_CACHE_SIZE = 32 * 1024 * 1024;
 const char C_SID[] = "SID"; // name of session id cookie
+const char PARAM_CACHE_ID[] = "v";
+// browsers allow few connections per host so the clients shouldn't hold them all by event streams
+const int MAX_EVENT_STREAMS_PER_SESSION = 4;
+const int MAX_EVENT_STREAMS_PER_CLIENT = 16;
+const int SESSIONS_CLEANUP_INTERVAL = 60000;  // 1 min
 
 const QString PATH_PREFIX_ICONS {QStringLiteral("/icons/")};
 const QString WWW_FOLDER {QStringLiteral(":/www")};
@@ -112,25 +129,71 @@ namespace
             return QLatin1String("private, max-age=43200");  // 12 hrs
         }
 
-        return QLatin1String("no-store");
+        // revalidated with ETag
+        return QLatin1String("private, no-cache");
+    }
+
+    bool matchesETag(const QString &ifNoneMatch, const QString &etag)
+    {
+        // [rfc7232] 3.2. If-None-Match
+        const QList<QStringView> tags = QStringView(ifNoneMatch).split(u',', Qt::SkipEmptyParts);
+        for (QStringView tag : tags)
+        {
+            tag = tag.trimmed();
+            if (tag == QLatin1String("*"))
+                return true;
+
+            // weak comparison
+            if (tag.startsWith(QLatin1String("W/")))
+                tag = tag.mid(2);
+            if (tag == etag)
+                return true;
+        }
+
+        return false;
+    }
+
+    QByteArray compressStaticContent(const QByteArray &data, const QString &mimeType)
+    {
+        // for very small files, compressing them only wastes cpu cycles
+        if (data.size() <= 1024)  // 1 kb
+            return {};
+
+        // filter out known hard-to-compress types
+        if ((mimeType == Http::CONTENT_TYPE_GIF) || (mimeType == Http::CONTENT_TYPE_PNG))
+            return {};
+
+        // files are compressed once so spend more time on it
+        bool ok = false;
+        const QByteArray compressedData = Utils::Gzip::compress(data, 9, &ok);
+        if (!ok || (compressedData.size() >= data.size()))
+            return {};
+
+        return compressedData;
     }
 }
 
 WebApplication::WebApplication(QObject *parent)
     : QObject(parent)
     , m_cacheID {QString::number(Utils::Random::rand(), 36)}
+    , m_torrentsChangeLog {new TorrentsChangeLog(this)}
 {
     registerAPIController(QLatin1String("app"), new AppController(this, this));
     registerAPIController(QLatin1String("auth"), new AuthController(this, this));
     registerAPIController(QLatin1String("log"), new LogController(this, this));
     registerAPIController(QLatin1String("rss"), new RSSController(this, this));
     registerAPIController(QLatin1String("search"), new SearchController(this, this));
-    registerAPIController(QLatin1String("sync"), new SyncController(this, this));
-    registerAPIController(QLatin1String("torrents"), new TorrentsController(this, this));
+    registerAPIController(QLatin1String("sync"), new SyncController(m_torrentsChangeLog, this, this));
+    registerAPIController(QLatin1String("torrents"), new TorrentsController(m_torrentsChangeLog, this, this));
     registerAPIController(QLatin1String("transfer"), new TransferController(this, this));
 
     declarePublicAPI(QLatin1String("auth/login"));
 
+    // sessions owning event streams may not get any requests to detect their expiration
+    auto *sessionsCleanupTimer = new QTimer(this);
+    connect(sessionsCleanupTimer, &QTimer::timeout, this, &WebApplication::removeExpiredSessions);
+    sessionsCleanupTimer->start(SESSIONS_CLEANUP_INTERVAL);
+
     configure();
     connect(Preferences::instance(), &Preferences::changed, this, &WebApplication::configure);
 }
@@ -203,6 +266,23 @@ void WebApplication::sendWebUIFile()
     sendFile(localPath);
 }
 
+void WebApplication::sendSerialized(const QVariant &data, const DataFormat format)
+{
+    // Content is compressed by the connection in its worker thread
+    if (format == DataFormat::CBOR)
+    {
+        CborWriter writer;
+        writer.write(data);
+        print(writer.data(), Http::CONTENT_TYPE_CBOR);
+    }
+    else
+    {
+        JsonWriter writer;
+        writer.write(data);
+        print(writer.data(), Http::CONTENT_TYPE_JSON);
+    }
+}
+
 void WebApplication::translateDocument(QString &data) const
 {
     const QRegularExpression regex("QBT_TR\\((([^\\)]|\\)(?!QBT_TR))+)\\)QBT_TR\\[CONTEXT=([a-zA-Z_][a-zA-Z0-9_]*)\\]");
@@ -276,17 +356,42 @@ void WebApplication::doProcessRequest()
     if (!session() && !isPublicAPI(scope, action))
         throw ForbiddenHTTPError();
 
+    // Client is active so keep torrent statuses up to date
+    if (session())
+        BitTorrent::Session::instance()->notifyRefreshDemand();
+
     DataMap data;
     for (const Http::UploadedFile &torrent : request().files)
         data[torrent.filename] = torrent.data;
 
+    // "Accept: application/cbor" is the same as "format=cbor" so controllers need to check the param only
+    if (!m_params.contains(PARAM_FORMAT)
+        && request().headers.value(Http::HEADER_ACCEPT).contains(QLatin1String(Http::CONTENT_TYPE_CBOR)))
+    {
+        m_params[PARAM_FORMAT] = FORMAT_CBOR;
+    }
+    const bool useCBOR = (m_params.value(PARAM_FORMAT) == QLatin1String(FORMAT_CBOR));
+
     try
     {
         const QVariant result = controller->run(action, m_params, data);
+        if (std::shared_ptr<Http::EventSource> eventSource = controller->takeEventSource())
+        {
+            openEventStream(std::move(eventSource));
+            return;
+        }
+
         switch (result.userType())
         {
         case QMetaType::QJsonDocument:
-            print(result.toJsonDocument().toJson(QJsonDocument::Compact), Http::CONTENT_TYPE_JSON);
+            if (useCBOR)
+                sendSerialized(result, DataFormat::CBOR);
+            else
+                print(result.toJsonDocument().toJson(QJsonDocument::Compact), Http::CONTENT_TYPE_JSON);
+            break;
+        case QMetaType::QVariantList:
+        case QMetaType::QVariantMap:
+            sendSerialized(result, (useCBOR ? DataFormat::CBOR : DataFormat::JSON));
             break;
         case QMetaType::QString:
         default:
@@ -326,7 +431,7 @@ void WebApplication::configure()
     {
         m_isAltUIUsed = isAltUIUsed;
         m_rootFolder = rootFolder;
-        m_translatedFiles.clear();
+        resetStaticFiles();
         if (!m_isAltUIUsed)
             LogMsg(tr("Using built-in Web UI."));
         else
@@ -337,7 +442,7 @@ void WebApplication::configure()
     if (m_currentLocale != newLocale)
     {
         m_currentLocale = newLocale;
-        m_translatedFiles.clear();
+        resetStaticFiles();
 
         m_translationFileLoaded = m_translator.load(m_rootFolder + QLatin1String("/translations/webui_") + newLocale);
         if (m_translationFileLoaded)
@@ -441,15 +546,64 @@ void WebApplication::sendFile(const QString &path)
 {
     const QDateTime lastModified {QFileInfo(path).lastModified()};
 
-    // find translated file in cache
-    const auto it = m_translatedFiles.constFind(path);
-    if ((it != m_translatedFiles.constEnd()) && (lastModified <= it->lastModified))
+    // find file in cache
+    auto it = m_staticFiles.constFind(path);
+    if ((it != m_staticFiles.constEnd()) && (lastModified > it->lastModified))
+    {
+        // files were changed so the clients have to stop using the cached ones
+        resetStaticFiles();
+        it = m_staticFiles.constEnd();
+    }
+
+    StaticFile loadedFile;
+    if (it == m_staticFiles.constEnd())
+    {
+        loadedFile = loadStaticFile(path, lastModified);
+
+        // files are served without caching them once the cache is full (e.g. with a large alternative Web UI)
+        const qint64 fileSize = loadedFile.data.size() + loadedFile.gzipData.size();
+        if ((m_staticFilesSize + fileSize) <= MAX_STATIC_FILES_CACHE_SIZE)
+        {
+            m_staticFilesSize += fileSize;
+            it = m_staticFiles.insert(path, loadedFile);
+        }
+    }
+
+    const StaticFile &file = (it != m_staticFiles.constEnd()) ? *it : loadedFile;
+    // the files of alternative Web UI can be changed independently of the pages referring to them
+    const bool isVersioned = !m_isAltUIUsed
+        && (QString::fromLatin1(request().query.value(QLatin1String(PARAM_CACHE_ID))) == m_cacheID);
+    const bool useGzip = !file.gzipData.isEmpty()
+        && Http::acceptsGzipEncoding(request().headers.value(Http::HEADER_ACCEPT_ENCODING));
+    const QString &etag = useGzip ? file.gzipETag : file.etag;
+
+    setHeader({Http::HEADER_CACHE_CONTROL, (isVersioned
+        ? QLatin1String("private, max-age=31536000, immutable")  // new cache id is used when content changes
+        : getCachingInterval(file.mimeType))});
+    setHeader({Http::HEADER_ETAG, etag});
+    if (!file.gzipData.isEmpty())
+        setHeader({Http::HEADER_VARY, QLatin1String(Http::HEADER_ACCEPT_ENCODING)});
+
+    if (matchesETag(request().headers.value(Http::HEADER_IF_NONE_MATCH), etag))
+    {
+        status(304, QLatin1String("Not Modified"));
+        return;
+    }
+
+    if (useGzip)
     {
-        print(it->data, it->mimeType);
-        setHeader({Http::HEADER_CACHE_CONTROL, getCachingInterval(it->mimeType)});
+        setHeader({Http::HEADER_CONTENT_ENCODING, QLatin1String("gzip")});
+        print(file.gzipData, file.mimeType);
         return;
     }
 
+    // compression was already tried when the file was loaded
+    setCompressible(false);
+    print(file.data, file.mimeType);
+}
+
+WebApplication::StaticFile WebApplication::loadStaticFile(const QString &path, const QDateTime &lastModified) const
+{
     QFile file {path};
     if (!file.open(QIODevice::ReadOnly))
     {
@@ -476,12 +630,24 @@ void WebApplication::sendFile(const QString &path)
         QString dataStr {data};
         translateDocument(dataStr);
         data = dataStr.toUtf8();
-
-        m_translatedFiles[path] = {data, mimeType.name(), lastModified}; // caching translated file
     }
 
-    print(data, mimeType.name());
-    setHeader({Http::HEADER_CACHE_CONTROL, getCachingInterval(mimeType.name())});
+    // [rfc7232] 2.3. ETag, each representation gets its own strong validator
+    const QString hash = QString::fromLatin1(QCryptographicHash::hash(data, QCryptographicHash::Sha1).toHex());
+    const QByteArray gzipData = compressStaticContent(data, mimeType.name());
+
+    const QString etag = QLatin1Char('"') + hash + QLatin1Char('"');
+    const QString gzipETag = QLatin1Char('"') + hash + QLatin1String("-gzip\"");
+
+    return {data, gzipData, mimeType.name(), etag, gzipETag, lastModified};
+}
+
+void WebApplication::resetStaticFiles()
+{
+    m_staticFiles.clear();
+    m_staticFilesSize = 0;
+    // the pages refer to the resources with cache id so clients won't use outdated ones
+    m_cacheID = QString::number(Utils::Random::rand(), 36);
 }
 
 Http::Response WebApplication::processRequest(const Http::Request &request, const Http::Environment &env)
@@ -552,6 +718,7 @@ void WebApplication::sessionInitialize()
             if (m_currentSession->hasExpired(m_sessionTimeout))
             {
                 // session is outdated - removing it
+                closeEventStreams(sessionId);
                 delete m_sessions.take(sessionId);
                 m_currentSession = nullptr;
             }
@@ -604,17 +771,7 @@ void WebApplication::sessionStart()
 {
     Q_ASSERT(!m_currentSession);
 
-    // remove outdated sessions
-    Algorithm::removeIf(m_sessions, [this](const QString &, const WebSession *session)
-    {
-        if (session->hasExpired(m_sessionTimeout))
-        {
-            delete session;
-            return true;
-        }
-
-        return false;
-    });
+    removeExpiredSessions();
 
     m_currentSession = new WebSession(generateSid());
     m_sessions[m_currentSession->id()] = m_currentSession;
@@ -637,12 +794,69 @@ void WebApplication::sessionEnd()
     cookie.setPath(QLatin1String("/"));
     cookie.setExpirationDate(QDateTime::currentDateTime().addDays(-1));
 
+    closeEventStreams(m_currentSession->id());
     delete m_sessions.take(m_currentSession->id());
     m_currentSession = nullptr;
 
     setHeader({Http::HEADER_SET_COOKIE, cookie.toRawForm()});
 }
 
+void WebApplication::removeExpiredSessions()
+{
+    Algorithm::removeIf(m_sessions, [this](const QString &sessionId, const WebSession *session)
+    {
+        if (session->hasExpired(m_sessionTimeout))
+        {
+            if (session == m_currentSession)
+                m_currentSession = nullptr;
+
+            closeEventStreams(sessionId);
+            delete session;
+            return true;
+        }
+
+        return false;
+    });
+}
+
+void WebApplication::openEventStream(std::shared_ptr<Http::EventSource> eventSource)
+{
+    Q_ASSERT(m_currentSession);
+
+    // forget the streams that were closed by the clients
+    m_eventStreams.erase(std::remove_if(m_eventStreams.begin(), m_eventStreams.end()
+        , [](const EventStream &stream) { return stream.eventSource.isNull(); })
+        , m_eventStreams.end());
+
+    const QString sessionId = m_currentSession->id();
+    const QString client = clientId();
+    const auto sessionStreamsCount = std::count_if(m_eventStreams.cbegin(), m_eventStreams.cend()
+        , [&sessionId](const EventStream &stream) { return (stream.sessionId == sessionId); });
+    const auto clientStreamsCount = std::count_if(m_eventStreams.cbegin(), m_eventStreams.cend()
+        , [&client](const EventStream &stream) { return (stream.clientId == client); });
+    // the source is released by the deleter
+    if ((sessionStreamsCount >= MAX_EVENT_STREAMS_PER_SESSION) || (clientStreamsCount >= MAX_EVENT_STREAMS_PER_CLIENT))
+        throw APIError(APIErrorType::Conflict, tr("Too many event streams are open"));
+
+    m_eventStreams.append({sessionId, client, eventSource.get()});
+    setEventSource(std::move(eventSource));
+}
+
+void WebApplication::closeEventStreams(const QString &sessionId)
+{
+    m_eventStreams.erase(std::remove_if(m_eventStreams.begin(), m_eventStreams.end()
+        , [&sessionId](const EventStream &stream)
+    {
+        if (stream.sessionId != sessionId)
+            return false;
+
+        // the connection closes the stream once its source is finished
+        if (stream.eventSource)
+            emit stream.eventSource->finished();
+        return true;
+    }), m_eventStreams.end());
+}
+
 bool WebApplication::isCrossSiteRequest(const Http::Request &request) const
 {
     // https://www.owasp.org/index.php/Cross-Site_Request_Forgery_(CSRF)_Prevention_Cheat_Sheet#Verifying_Same_Origin_with_Standard_Headers
@@ -28,10 +28,13 @@
 
 #pragma once
 
+#include <memory>
+
 #include <QDateTime>
 #include <QElapsedTimer>
 #include <QHash>
 #include <QObject>
+#include <QPointer>
 #include <QRegularExpression>
 #include <QSet>
 #include <QTranslator>
@@ -43,11 +46,17 @@
 #include "base/utils/net.h"
 #include "base/utils/version.h"
 
-inline const Utils::Version<int, 3, 2> API_VERSION {2, 8, 3};
+inline const Utils::Version<int, 3, 2> API_VERSION {2, 8, 8};
 
 class APIController;
+class TorrentsChangeLog;
 class WebApplication;
 
+namespace Http
+{
+    class EventSource;
+}
+
 class WebSession final : public ISession
 {
 public:
@@ -100,14 +109,36 @@ private:
     void registerAPIController(const QString &scope, APIController *controller);
     void declarePublicAPI(const QString &apiPath);
 
+    struct StaticFile
+    {
+        QByteArray data;
+        QByteArray gzipData;  // empty if compression isn't worth it
+        QString mimeType;
+        QString etag;
+        QString gzipETag;
+        QDateTime lastModified;
+    };
+
     void sendFile(const QString &path);
     void sendWebUIFile();
+    StaticFile loadStaticFile(const QString &path, const QDateTime &lastModified) const;
+    void resetStaticFiles();
+    enum class DataFormat
+    {
+        JSON,
+        CBOR
+    };
+
+    void sendSerialized(const QVariant &data, DataFormat format);
+    void openEventStream(std::shared_ptr<Http::EventSource> eventSource);
+    void closeEventStreams(const QString &sessionId);
 
     void translateDocument(QString &data) const;
 
     // Session management
     QString generateSid() const;
     void sessionInitialize();
+    void removeExpiredSessions();
     bool isAuthNeeded();
     bool isPublicAPI(const QString &scope, const QString &action) const;
 
@@ -119,27 +150,34 @@ private:
     // Persistent data
     QHash<QString, WebSession *> m_sessions;
 
+    struct EventStream
+    {
+        QString sessionId;
+        QString clientId;
+        QPointer<Http::EventSource> eventSource;
+    };
+    // Event streams don't expire on their own so they are closed along with their sessions
+    QVector<EventStream> m_eventStreams;
+
     // Current data
     WebSession *m_currentSession = nullptr;
     Http::Request m_request;
     Http::Environment m_env;
     QHash<QString, QString> m_params;
-    const QString m_cacheID;
+    QString m_cacheID;
 
     const QRegularExpression m_apiPathPattern {QLatin1String("^/api/v2/(?<scope>[A-Za-z_][A-Za-z_0-9]*)/(?<action>[A-Za-z_][A-Za-z_0-9]*)$")};
 
+    // Shared by the controllers that serialize torrents
+    TorrentsChangeLog *m_torrentsChangeLog = nullptr;
     QHash<QString, APIController *> m_apiControllers;
     QSet<QString> m_publicAPIs;
     bool m_isAltUIUsed = false;
     QString m_rootFolder;
 
-    struct TranslatedFile
-    {
-        QByteArray data;
-        QString mimeType;
-        QDateTime lastModified;
-    };
-    QHash<QString, TranslatedFile> m_translatedFiles;
+    // Translated and compressed files, the built-in resources referring to `m_cacheID` can be cached by client indefinitely
+    QHash<QString, StaticFile> m_staticFiles;
+    qint64 m_staticFilesSize = 0;
     QString m_currentLocale;
     QTranslator m_translator;
     bool m_translationFileLoaded = false;
@@ -3,12 +3,15 @@ HEADERS += \
     $$PWD/api/apierror.h \
     $$PWD/api/appcontroller.h \
     $$PWD/api/authcontroller.h \
+    $$PWD/api/cborwriter.h \
     $$PWD/api/freediskspacechecker.h \
     $$PWD/api/isessionmanager.h \
+    $$PWD/api/jsonwriter.h \
     $$PWD/api/logcontroller.h \
     $$PWD/api/rsscontroller.h \
     $$PWD/api/searchcontroller.h \
     $$PWD/api/synccontroller.h \
+    $$PWD/api/torrentschangelog.h \
     $$PWD/api/torrentscontroller.h \
     $$PWD/api/transfercontroller.h \
     $$PWD/api/serialize/serialize_torrent.h \
@@ -20,11 +23,14 @@ SOURCES += \
     $$PWD/api/apierror.cpp \
     $$PWD/api/appcontroller.cpp \
     $$PWD/api/authcontroller.cpp \
+    $$PWD/api/cborwriter.cpp \
     $$PWD/api/freediskspacechecker.cpp \
+    $$PWD/api/jsonwriter.cpp \
     $$PWD/api/logcontroller.cpp \
     $$PWD/api/rsscontroller.cpp \
     $$PWD/api/searchcontroller.cpp \
     $$PWD/api/synccontroller.cpp \
+    $$PWD/api/torrentschangelog.cpp \
     $$PWD/api/torrentscontroller.cpp \
     $$PWD/api/transfercontroller.cpp \
     $$PWD/api/serialize/serialize_torrent.cpp \